@@ -0,0 +1,222 @@
+//------------------------------------------------------------------------------
+// Timing driver comparing the Array2 memory layouts (ColMajorLayout,
+// RowMajorLayout and TiledLayout) on a breadth first floodfill, and on
+// iterating over all elements in different orders.
+//
+// This is not part of the library, build it together with the library sources
+// and the "global.hpp" of your project, e.g.:
+//
+//   g++ -std=c++11 -O2 -DNDEBUG -Iinclude -I<dir of global.hpp>
+//       bench/array2_layouts.cpp src/*.cpp -o array2_layouts
+//
+// (all on one line)
+//
+// The floodfill functions of the library only work on column major grids, so
+// the floodfill here is a plain breadth first search written against Array2,
+// to measure only the effect of the layout.
+//------------------------------------------------------------------------------
+
+#include "rl_utils.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+
+const P grid_dims(512, 512);
+
+const int nr_flood_runs = 20;
+
+const int nr_iter_runs = 50;
+
+// Prevents the compiler from optimizing away the timed work
+volatile long long sink = 0;
+
+typedef std::chrono::steady_clock Clock;
+
+long long us_since(const Clock::time_point& t0)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - t0).count();
+}
+
+template<typename Layout>
+void init_blocked(Array2<bool, Layout>& blocked)
+{
+    // Same cells for each layout
+    std::mt19937 rng(1234);
+
+    for (int x = 0; x < grid_dims.x; ++x)
+    {
+        for (int y = 0; y < grid_dims.y; ++y)
+        {
+            const bool is_edge =
+                (x == 0) ||
+                (y == 0) ||
+                (x == (grid_dims.x - 1)) ||
+                (y == (grid_dims.y - 1));
+
+            blocked(x, y) = is_edge || ((rng() % 100) < 30);
+        }
+    }
+
+    blocked(grid_dims / 2) = false;
+}
+
+template<typename Layout>
+long long time_flood(const Array2<bool, Layout>& blocked,
+                     Array2<int, Layout>& vals)
+{
+    const P p0(grid_dims / 2);
+
+    std::vector<P> positions;
+
+    positions.reserve(grid_dims.x * grid_dims.y);
+
+    const auto t0 = Clock::now();
+
+    for (int run = 0; run < nr_flood_runs; ++run)
+    {
+        vals.fill(0);
+
+        positions.clear();
+
+        positions.push_back(p0);
+
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            const P p(positions[i]);
+
+            const int val = vals(p);
+
+            for (const P& d : dir_utils::dir_list)
+            {
+                const P new_p(p + d);
+
+                if (blocked(new_p) ||
+                    (vals(new_p) != 0) ||
+                    (new_p == p0))
+                {
+                    continue;
+                }
+
+                vals(new_p) = val + 1;
+
+                positions.push_back(new_p);
+            }
+        }
+
+        sink = sink + positions.size();
+    }
+
+    return us_since(t0);
+}
+
+template<typename Layout>
+long long time_col_loops(const Array2<int, Layout>& vals)
+{
+    const auto t0 = Clock::now();
+
+    for (int run = 0; run < nr_iter_runs; ++run)
+    {
+        long long sum = 0;
+
+        for (int x = 0; x < grid_dims.x; ++x)
+        {
+            for (int y = 0; y < grid_dims.y; ++y)
+            {
+                sum += vals(x, y);
+            }
+        }
+
+        sink = sink + sum;
+    }
+
+    return us_since(t0);
+}
+
+template<typename Layout>
+long long time_row_loops(const Array2<int, Layout>& vals)
+{
+    const auto t0 = Clock::now();
+
+    for (int run = 0; run < nr_iter_runs; ++run)
+    {
+        long long sum = 0;
+
+        for (int y = 0; y < grid_dims.y; ++y)
+        {
+            for (int x = 0; x < grid_dims.x; ++x)
+            {
+                sum += vals(x, y);
+            }
+        }
+
+        sink = sink + sum;
+    }
+
+    return us_since(t0);
+}
+
+template<typename Layout>
+long long time_for_each_pos(const Array2<int, Layout>& vals)
+{
+    const auto t0 = Clock::now();
+
+    for (int run = 0; run < nr_iter_runs; ++run)
+    {
+        long long sum = 0;
+
+        vals.for_each_pos(
+            [&](const P& p, const int v)
+            {
+                (void)p;
+
+                sum += v;
+            });
+
+        sink = sink + sum;
+    }
+
+    return us_since(t0);
+}
+
+template<typename Layout>
+void run(const char* const name)
+{
+    Array2<bool, Layout> blocked(grid_dims);
+
+    Array2<int, Layout> vals(grid_dims);
+
+    init_blocked(blocked);
+
+    const long long flood_us = time_flood(blocked, vals);
+
+    printf("%-8s flood: %8lld us, "
+           "column loops: %8lld us, "
+           "row loops: %8lld us, "
+           "for_each_pos: %8lld us\n",
+           name,
+           flood_us,
+           time_col_loops(vals),
+           time_row_loops(vals),
+           time_for_each_pos(vals));
+}
+
+} // namespace
+
+int main()
+{
+    printf("Grid size: %dx%d, %d floods, %d iterations\n",
+           grid_dims.x,
+           grid_dims.y,
+           nr_flood_runs,
+           nr_iter_runs);
+
+    run<ColMajorLayout>("ColMajor");
+    run<RowMajorLayout>("RowMajor");
+    run<TiledLayout>("Tiled");
+
+    return 0;
+}
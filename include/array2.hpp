@@ -2,74 +2,264 @@
 #define RL_UTILS_ARRAY2_HPP
 
 #include <functional>
+#include <algorithm>
+#include <new>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
 
 #include "pos.hpp"
 
+//------------------------------------------------------------------------------
+// Memory layouts for Array2. Each layout maps positions to element indexes,
+// and can iterate over all positions in the order they are stored in memory
+// (see "Array2::for_each_pos"), so that loops can use the fastest order for
+// any layout.
+//------------------------------------------------------------------------------
+
+// Column by column (same as map arrays) - this is the default layout, and the
+// only one which can be used with GridView
+struct ColMajorLayout
+{
+    static size_t storage_size(const P& dims)
+    {
+        return dims.x * dims.y;
+    }
+
+    static size_t pos_to_idx(const P& p, const P& dims)
+    {
+        return (p.x * dims.y) + p.y;
+    }
+
+    template<typename Func>
+    static void for_each_idx(const P& dims, Func func)
+    {
+        size_t idx = 0;
+
+        for (int x = 0; x < dims.x; ++x)
+        {
+            for (int y = 0; y < dims.y; ++y)
+            {
+                func(P(x, y), idx);
+
+                ++idx;
+            }
+        }
+    }
+};
+
+// Row by row, for code which mostly scans along rows (e.g. rendering)
+struct RowMajorLayout
+{
+    static size_t storage_size(const P& dims)
+    {
+        return dims.x * dims.y;
+    }
+
+    static size_t pos_to_idx(const P& p, const P& dims)
+    {
+        return (p.y * dims.x) + p.x;
+    }
+
+    template<typename Func>
+    static void for_each_idx(const P& dims, Func func)
+    {
+        size_t idx = 0;
+
+        for (int y = 0; y < dims.y; ++y)
+        {
+            for (int x = 0; x < dims.x; ++x)
+            {
+                func(P(x, y), idx);
+
+                ++idx;
+            }
+        }
+    }
+};
+
+// 8x8 tiles (stored column by column), where the cells within each tile are
+// stored in Morton (Z-curve) order. Nearby cells in any direction are usually
+// close in memory, which suits algorithms spreading out in two dimensions
+// (e.g. floodfill or FOV). The storage is padded to whole tiles.
+struct TiledLayout
+{
+    static const int tile_size = 8;
+
+    static size_t storage_size(const P& dims)
+    {
+        return
+            nr_tiles(dims.x) *
+            nr_tiles(dims.y) *
+            (tile_size * tile_size);
+    }
+
+    static size_t pos_to_idx(const P& p, const P& dims)
+    {
+        const size_t tile_idx =
+            ((p.x / tile_size) * nr_tiles(dims.y)) +
+            (p.y / tile_size);
+
+        const size_t morton_idx =
+            spread_bits(p.x % tile_size) |
+            (spread_bits(p.y % tile_size) << 1);
+
+        return (tile_idx * (tile_size * tile_size)) + morton_idx;
+    }
+
+    template<typename Func>
+    static void for_each_idx(const P& dims, Func func)
+    {
+        size_t idx = 0;
+
+        for (int tile_x = 0; tile_x < nr_tiles(dims.x); ++tile_x)
+        {
+            for (int tile_y = 0; tile_y < nr_tiles(dims.y); ++tile_y)
+            {
+                for (int i = 0; i < (tile_size * tile_size); ++i)
+                {
+                    const P p(
+                        (tile_x * tile_size) + compact_bits(i),
+                        (tile_y * tile_size) + compact_bits(i >> 1));
+
+                    // Skip the padding
+                    if ((p.x < dims.x) && (p.y < dims.y))
+                    {
+                        func(p, idx);
+                    }
+
+                    ++idx;
+                }
+            }
+        }
+    }
+
+private:
+    static int nr_tiles(const int len)
+    {
+        return (len + tile_size - 1) / tile_size;
+    }
+
+    // Bits "abc" -> "a0b0c"
+    static size_t spread_bits(const int v)
+    {
+        return (v & 1) | ((v & 2) << 1) | ((v & 4) << 2);
+    }
+
+    // Bits "a?b?c" -> "abc"
+    static int compact_bits(const int v)
+    {
+        return (v & 1) | ((v >> 1) & 2) | ((v >> 2) & 4);
+    }
+};
+
 // Two dimensional array class
-template<typename T>
+template<typename T, typename Layout = ColMajorLayout>
 class Array2
 {
 public:
+    // The storage is aligned to cache lines (and vector registers)
+    static const size_t alignment = 64;
+
     Array2() :
-        data_   (nullptr),
-        dims_   (0, 0) {}
+        data_       (nullptr),
+        dims_       (0, 0),
+        buffer_     (nullptr),
+        capacity_   (0) {}
 
     Array2(const P& dims) :
-        data_   (nullptr),
-        dims_   ()
+        data_       (nullptr),
+        dims_       (),
+        buffer_     (nullptr),
+        capacity_   (0)
     {
         resize(dims);
     }
 
     Array2(const int w, const int h) :
-        data_   (nullptr),
-        dims_   ()
+        data_       (nullptr),
+        dims_       (),
+        buffer_     (nullptr),
+        capacity_   (0)
     {
         resize(P(w, h));
     }
 
     ~Array2()
     {
-        delete[] data_;
+        free_storage();
     }
 
-    Array2(const Array2<T>& other) :
-        data_   (nullptr),
-        dims_   ()
+    Array2(const Array2& other) :
+        data_       (nullptr),
+        dims_       (),
+        buffer_     (nullptr),
+        capacity_   (0)
     {
-        resize(other.dims_);
+        copy_from(other);
+    }
 
-        const size_t size = nr_elements();
+    Array2(Array2&& other) noexcept :
+        data_       (other.data_),
+        dims_       (other.dims_),
+        buffer_     (other.buffer_),
+        capacity_   (other.capacity_)
+    {
+        other.data_ = nullptr;
+        other.dims_.set(0, 0);
+        other.buffer_ = nullptr;
+        other.capacity_ = 0;
+    }
 
-        for (size_t idx = 0; idx < size; ++idx)
+    Array2& operator=(const Array2& other)
+    {
+        if (&other != this)
         {
-            data_[idx] = other.data_[idx];
+            copy_from(other);
         }
+
+        return *this;
     }
 
-    Array2<T>& operator=(const Array2<T>& other)
+    Array2& operator=(Array2&& other) noexcept
     {
-        resize(other.dims_);
-
-        const size_t size = nr_elements();
-
-        for (size_t idx = 0; idx < size; ++idx)
+        if (&other != this)
         {
-            data_[idx] = other.data_[idx];
+            free_storage();
+
+            swap(other);
         }
 
         return *this;
     }
 
+    void swap(Array2& other) noexcept
+    {
+        std::swap(data_, other.data_);
+        std::swap(dims_, other.dims_);
+        std::swap(buffer_, other.buffer_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    // NOTE: If the new size fits in the current storage, no memory is
+    // allocated. As before, the element values are unspecified after resizing
+    // (except that class types are default constructed).
     void resize(const P& dims)
     {
         dims_ = dims;
 
-        const size_t size = nr_elements();
+        const size_t size = storage_size();
 
-        delete[] data_;
+        if (size > capacity_)
+        {
+            free_storage();
 
-        data_ = new T[size];
+            allocate_storage(size);
+        }
+        else if (!std::is_trivial<T>::value)
+        {
+            std::fill_n(data_, size, T());
+        }
     }
 
     void resize(const int w, const int h)
@@ -81,7 +271,7 @@ public:
     {
         const P my_dims(dims());
 
-        Array2<T> rotated(my_dims.y, my_dims.x);
+        Array2 rotated(my_dims.y, my_dims.x);
 
         for (int x = 0; x < my_dims.x; ++x)
         {
@@ -93,14 +283,14 @@ public:
             }
         }
 
-        *this = rotated;
+        swap(rotated);
     }
 
     void rotate_ccw()
     {
         const P my_dims(dims());
 
-        Array2<T> rotated(my_dims.y, my_dims.x);
+        Array2 rotated(my_dims.y, my_dims.x);
 
         for (int x = 0; x < my_dims.x; ++x)
         {
@@ -112,7 +302,7 @@ public:
             }
         }
 
-        *this = rotated;
+        swap(rotated);
     }
 
     void flip_hor()
@@ -158,7 +348,7 @@ public:
 
     const T& operator()(const P& p) const
     {
-        return (*const_cast<Array2<T>*>(this))(p);
+        return (*const_cast<Array2*>(this))(p);
     }
 
     T& operator()(const int x, const int y)
@@ -173,30 +363,297 @@ public:
 
     void for_each(std::function<void(T& v)> func)
     {
-        const size_t size = nr_elements();
+        Layout::for_each_idx(
+            dims_,
+            [&](const P& p, const size_t idx)
+            {
+                (void)p;
+
+                func(data_[idx]);
+            });
+    }
+
+    // Calls "func(const P& p, T& v)" for each position and element, in the
+    // order the elements are stored in memory (this is the fastest way to
+    // visit all elements, regardless of the layout)
+    template<typename Func>
+    void for_each_pos(Func func)
+    {
+        Layout::for_each_idx(
+            dims_,
+            [&](const P& p, const size_t idx)
+            {
+                func(p, data_[idx]);
+            });
+    }
+
+    // Same as above, but calls "func(const P& p, const T& v)"
+    template<typename Func>
+    void for_each_pos(Func func) const
+    {
+        Layout::for_each_idx(
+            dims_,
+            [&](const P& p, const size_t idx)
+            {
+                const T& v = data_[idx];
+
+                func(p, v);
+            });
+    }
+
+    //--------------------------------------------------------------------------
+    // Bulk operations - these work directly on the element storage, in simple
+    // loops which the compiler can inline and vectorize for arithmetic types
+    // (unlike "for_each", which makes an indirect call per element).
+    //--------------------------------------------------------------------------
+    void fill(const T& v)
+    {
+        std::fill_n(data_, storage_size(), v);
+    }
+
+    // Sets each element to "func(v)"
+    template<typename Func>
+    void transform(Func func)
+    {
+        T* const d = data_;
+
+        const size_t size = storage_size();
+
+        for (size_t idx = 0; idx < size; ++idx)
+        {
+            d[idx] = func(d[idx]);
+        }
+    }
+
+    // Sets each element to "func(v, other_v)", where "other_v" is the element
+    // at the same position in "other" (which must have the same size)
+    template<typename U, typename Func>
+    void transform(const Array2<U, Layout>& other, Func func)
+    {
+        ASSERT(other.dims() == dims_);
+
+        T* const d = data_;
+
+        const U* const other_d = other.data();
+
+        const size_t size = storage_size();
+
+        for (size_t idx = 0; idx < size; ++idx)
+        {
+            d[idx] = func(d[idx], other_d[idx]);
+        }
+    }
+
+    // Same as "set_constr_in_range" for each element (nothing is done if "max"
+    // is lower than "min")
+    void constr_in_range(const T& min, const T& max)
+    {
+        if (max < min)
+        {
+            return;
+        }
+
+        transform(
+            [min, max](const T& v)
+            {
+                return (v < min) ? min : ((max < v) ? max : v);
+            });
+    }
+
+    // Sets each cell in "out" to true if the value is at or above "threshold"
+    // (e.g. to get the cells which are lit enough to be seen)
+    void to_mask(const T& threshold, Array2<bool, Layout>& out) const
+    {
+        out.resize(dims_);
+
+        const T* const d = data_;
+
+        bool* const out_d = out.data();
+
+        const size_t size = storage_size();
 
         for (size_t idx = 0; idx < size; ++idx)
         {
-            func(data_[idx]);
+            out_d[idx] = !(d[idx] < threshold);
         }
     }
 
+    // NOTE: The array must not be empty
+    T min_val() const
+    {
+        ASSERT(dims_.x > 0 && dims_.y > 0);
+
+        T result = data_[pos_to_idx(0, 0)];
+
+        reduce(
+            [&result](const T& v)
+            {
+                result = (v < result) ? v : result;
+            });
+
+        return result;
+    }
+
+    // NOTE: The array must not be empty
+    T max_val() const
+    {
+        ASSERT(dims_.x > 0 && dims_.y > 0);
+
+        T result = data_[pos_to_idx(0, 0)];
+
+        reduce(
+            [&result](const T& v)
+            {
+                result = (result < v) ? v : result;
+            });
+
+        return result;
+    }
+
+    // The sum of all elements - a wider type can be used for the sum to avoid
+    // overflow (e.g. "sum<long long>()" for a large array of int)
+    template<typename S = T>
+    S sum() const
+    {
+        S result = S();
+
+        reduce(
+            [&result](const T& v)
+            {
+                result += v;
+            });
+
+        return result;
+    }
+
+    // Frees all memory
     void clear()
     {
-        delete[] data_;
+        free_storage();
 
         dims_.set(0, 0);
     }
 
+    // Number of elements which fit in the current storage
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
     const P& dims() const
     {
         return dims_;
     }
 
+    // The elements are stored according to the layout (column by column for
+    // the default layout)
+    T* data()
+    {
+        return data_;
+    }
+
+    const T* data() const
+    {
+        return data_;
+    }
+
 private:
+    void allocate_storage(const size_t size)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+
+        buffer_ = ::operator new((size * sizeof(T)) + alignment - 1);
+
+        const uintptr_t aligned_addr =
+            (reinterpret_cast<uintptr_t>(buffer_) + alignment - 1) &
+            ~(uintptr_t)(alignment - 1);
+
+        data_ = reinterpret_cast<T*>(aligned_addr);
+
+        // NOTE: The elements are default initialized (for trivial types, this
+        // leaves the values unset without writing to the memory). If the
+        // layout can have padding, trivial types are set to zero instead, so
+        // that the padding holds valid values for the bulk operations.
+        const bool is_padded_layout = Layout::storage_size(P(1, 1)) != 1;
+
+        if (std::is_trivial<T>::value && is_padded_layout)
+        {
+            for (size_t idx = 0; idx < size; ++idx)
+            {
+                new (data_ + idx) T();
+            }
+        }
+        else
+        {
+            for (size_t idx = 0; idx < size; ++idx)
+            {
+                new (data_ + idx) T;
+            }
+        }
+
+        capacity_ = size;
+    }
+
+    void free_storage()
+    {
+        for (size_t idx = 0; idx < capacity_; ++idx)
+        {
+            data_[idx].~T();
+        }
+
+        ::operator delete(buffer_);
+
+        data_ = nullptr;
+        buffer_ = nullptr;
+        capacity_ = 0;
+    }
+
+    // Calls "func" for each element (without any padding of the layout)
+    template<typename Func>
+    void reduce(Func func) const
+    {
+        const size_t size = storage_size();
+
+        if (size == (size_t)(dims_.x * dims_.y))
+        {
+            const T* const d = data_;
+
+            for (size_t idx = 0; idx < size; ++idx)
+            {
+                func(d[idx]);
+            }
+        }
+        else
+        {
+            Layout::for_each_idx(
+                dims_,
+                [&](const P& p, const size_t idx)
+                {
+                    (void)p;
+
+                    func(data_[idx]);
+                });
+        }
+    }
+
+    void copy_from(const Array2& other)
+    {
+        resize(other.dims_);
+
+        const size_t size = storage_size();
+
+        for (size_t idx = 0; idx < size; ++idx)
+        {
+            data_[idx] = other.data_[idx];
+        }
+    }
+
     size_t pos_to_idx(const P& p) const
     {
-        return (p.x * dims_.y) + p.y;
+        return Layout::pos_to_idx(p, dims_);
     }
 
     size_t pos_to_idx(const int x, const int y) const
@@ -204,9 +661,10 @@ private:
         return pos_to_idx(P(x, y));
     }
 
-    size_t nr_elements() const
+    // Number of stored elements (this includes any padding of the layout)
+    size_t storage_size() const
     {
-        return dims_.x * dims_.y;
+        return Layout::storage_size(dims_);
     }
 
     void check_pos(const P& p) const
@@ -219,6 +677,13 @@ private:
 
     T* data_;
     P dims_;
+
+    // The allocated memory, "data_" points to the first aligned element
+    void* buffer_;
+    size_t capacity_;
 };
 
+template<typename T, typename Layout>
+const size_t Array2<T, Layout>::alignment;
+
 #endif // RL_UTILS_ARRAY2_HPP
@@ -0,0 +1,209 @@
+#ifndef RL_UTILS_ARRAY2_VIEW_HPP
+#define RL_UTILS_ARRAY2_VIEW_HPP
+
+#include <type_traits>
+
+#include "pos.hpp"
+#include "rect.hpp"
+#include "array2.hpp"
+
+//------------------------------------------------------------------------------
+// Non-owning view of an Array2 (or a part of it), rotated and/or flipped in
+// any of the eight possible orientations, without copying any elements. The
+// view transformations give the same result as the corresponding Array2
+// functions ("rotate_cw", "flip_hor", etc), but are cheap to combine - e.g.
+// for trying each orientation of a map template.
+//
+// Each view position is mapped to a position in the array as:
+// "origin + (x * x_step) + (y * y_step)", where the steps are unit offsets.
+//------------------------------------------------------------------------------
+template<typename T, typename Layout = ColMajorLayout>
+class Array2View
+{
+public:
+    typedef typename std::remove_const<T>::type ValueType;
+
+    typedef typename std::conditional<
+        std::is_const<T>::value,
+        const Array2<ValueType, Layout>,
+        Array2<ValueType, Layout> >::type ArrayType;
+
+    // View of the whole array, without any transformation
+    Array2View(ArrayType& a) :
+        array_  (&a),
+        dims_   (a.dims()),
+        origin_ (0, 0),
+        x_step_ (1, 0),
+        y_step_ (0, 1) {}
+
+    operator Array2View<const T, Layout>() const
+    {
+        return Array2View<const T, Layout>(
+            *array_,
+            dims_,
+            origin_,
+            x_step_,
+            y_step_);
+    }
+
+    // NOTE: This is mostly for internal use, see the functions below
+    Array2View(ArrayType& a,
+               const P& dims,
+               const P& origin,
+               const P& x_step,
+               const P& y_step) :
+        array_  (&a),
+        dims_   (dims),
+        origin_ (origin),
+        x_step_ (x_step),
+        y_step_ (y_step) {}
+
+    Array2View rotated_cw() const
+    {
+        return Array2View(
+            *array_,
+            P(dims_.y, dims_.x),
+            array_pos(P(0, dims_.y - 1)),
+            P(0, 0) - y_step_,
+            x_step_);
+    }
+
+    Array2View rotated_ccw() const
+    {
+        return Array2View(
+            *array_,
+            P(dims_.y, dims_.x),
+            array_pos(P(dims_.x - 1, 0)),
+            y_step_,
+            P(0, 0) - x_step_);
+    }
+
+    Array2View flipped_hor() const
+    {
+        return Array2View(
+            *array_,
+            dims_,
+            array_pos(P(dims_.x - 1, 0)),
+            P(0, 0) - x_step_,
+            y_step_);
+    }
+
+    Array2View flipped_ver() const
+    {
+        return Array2View(
+            *array_,
+            dims_,
+            array_pos(P(0, dims_.y - 1)),
+            x_step_,
+            P(0, 0) - y_step_);
+    }
+
+    // One of the eight orientations (0 to 7) - the view is rotated clockwise
+    // "orientation % 4" times, and for 4 and above it is also flipped
+    // horizontally. Orientation 0 is the view itself.
+    Array2View oriented(const int orientation) const
+    {
+        ASSERT(orientation >= 0 && orientation < 8);
+
+        Array2View result(*this);
+
+        for (int i = 0; i < (orientation % 4); ++i)
+        {
+            result = result.rotated_cw();
+        }
+
+        if (orientation >= 4)
+        {
+            result = result.flipped_hor();
+        }
+
+        return result;
+    }
+
+    // View of a part of this view, positions in the new view are relative to
+    // the top left corner of the area
+    Array2View sub(const R& area) const
+    {
+        ASSERT(is_p_inside(area.p0));
+        ASSERT(is_p_inside(area.p1));
+
+        return Array2View(
+            *array_,
+            area.dims(),
+            array_pos(area.p0),
+            x_step_,
+            y_step_);
+    }
+
+    T& operator()(const P& p) const
+    {
+        ASSERT(is_p_inside(p));
+
+        return (*array_)(array_pos(p));
+    }
+
+    T& operator()(const int x, const int y) const
+    {
+        return (*this)(P(x, y));
+    }
+
+    // Calls "func(const P& p, T& v)" for each position in the view
+    template<typename Func>
+    void for_each_pos(Func func) const
+    {
+        for (int x = 0; x < dims_.x; ++x)
+        {
+            P p(array_pos(P(x, 0)));
+
+            for (int y = 0; y < dims_.y; ++y)
+            {
+                func(P(x, y), (*array_)(p));
+
+                p += y_step_;
+            }
+        }
+    }
+
+    // Copies the elements into a new array, with the dimensions of the view
+    Array2<ValueType, Layout> to_array() const
+    {
+        Array2<ValueType, Layout> result(dims_);
+
+        for_each_pos(
+            [&result](const P& p, const T& v)
+            {
+                result(p) = v;
+            });
+
+        return result;
+    }
+
+    bool is_p_inside(const P& p) const
+    {
+        return
+            (p.x >= 0) &&
+            (p.y >= 0) &&
+            (p.x < dims_.x) &&
+            (p.y < dims_.y);
+    }
+
+    const P& dims() const
+    {
+        return dims_;
+    }
+
+    // The position in the array corresponding to a position in the view
+    P array_pos(const P& p) const
+    {
+        return origin_ + (x_step_ * p.x) + (y_step_ * p.y);
+    }
+
+private:
+    ArrayType* array_;
+    P dims_;
+    P origin_;
+    P x_step_;
+    P y_step_;
+};
+
+#endif // RL_UTILS_ARRAY2_VIEW_HPP
@@ -0,0 +1,127 @@
+#ifndef RL_UTILS_BIT_GRID_HPP
+#define RL_UTILS_BIT_GRID_HPP
+
+#include <vector>
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+// Grid of booleans packed into bits (one 64 bit word holds 64 cells of a row),
+// for e.g. blocked, seen or explored cells. Combining grids with the boolean
+// operators works on whole words at a time, which is much cheaper than looping
+// over a bool array.
+//------------------------------------------------------------------------------
+class BitGrid
+{
+public:
+    // The size of the map
+    BitGrid();
+
+    explicit BitGrid(const P& dims);
+
+    // Converts a map array
+    explicit BitGrid(const bool a[map_w][map_h]);
+
+    // NOTE: The grid must be the size of the map
+    void to_array(bool out[map_w][map_h]) const;
+
+    const P& dims() const
+    {
+        return dims_;
+    }
+
+    bool at(const P& p) const
+    {
+        return (row(p.y)[p.x / 64] >> (p.x % 64)) & 1;
+    }
+
+    void set(const P& p, const bool v)
+    {
+        uint64_t& word = row(p.y)[p.x / 64];
+
+        const uint64_t bit = uint64_t(1) << (p.x % 64);
+
+        word = v ? (word | bit) : (word & ~bit);
+    }
+
+    void fill(const bool v);
+
+    // Number of set cells
+    int count() const;
+
+    bool is_any() const;
+
+    // The first set cell (row by row, from the top left), or (-1, -1) if no
+    // cell is set
+    P find_first() const;
+
+    // The next set cell after "p" (row by row), or (-1, -1) if there is none
+    P find_next(const P& p) const;
+
+    // Moves all cells one step in a direction, cells moved outside the grid
+    // are dropped, and the cells moved in from outside are cleared. This is
+    // useful for e.g. expanding an area: "grid |= shifted grid".
+    void shift(const Dir dir);
+
+    // Inverts all cells
+    void flip();
+
+    // NOTE: The grids must have the same size
+    BitGrid& operator&=(const BitGrid& other);
+    BitGrid& operator|=(const BitGrid& other);
+    BitGrid& operator^=(const BitGrid& other);
+
+    BitGrid operator&(const BitGrid& other) const
+    {
+        return BitGrid(*this) &= other;
+    }
+
+    BitGrid operator|(const BitGrid& other) const
+    {
+        return BitGrid(*this) |= other;
+    }
+
+    BitGrid operator^(const BitGrid& other) const
+    {
+        return BitGrid(*this) ^= other;
+    }
+
+    BitGrid operator~() const
+    {
+        BitGrid result(*this);
+
+        result.flip();
+
+        return result;
+    }
+
+    bool operator==(const BitGrid& other) const
+    {
+        return (dims_ == other.dims_) && (words_ == other.words_);
+    }
+
+    bool operator!=(const BitGrid& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    uint64_t* row(const int y)
+    {
+        return &words_[y * nr_row_words_];
+    }
+
+    const uint64_t* row(const int y) const
+    {
+        return &words_[y * nr_row_words_];
+    }
+
+    // Clears the unused bits of the last word on each row, which must always
+    // be zero
+    void clear_padding();
+
+    P dims_;
+    int nr_row_words_;
+    std::vector<uint64_t> words_;
+};
+
+#endif // RL_UTILS_BIT_GRID_HPP
@@ -0,0 +1,190 @@
+#ifndef RL_UTILS_COMPACT_PATH_HPP
+#define RL_UTILS_COMPACT_PATH_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//------------------------------------------------------------------------------
+// Compact storage of a path - an origin position, and a three bit direction
+// code per step, packed into 64 bit words. Short paths (up to
+// "nr_inline_steps") are stored inside the object without allocating memory.
+// This is useful for keeping paths for many monsters in memory.
+//
+// Iterating over the path gives the position after each step, starting with
+// the first step from the origin and ending with the target (i.e. the reverse
+// order of the "pathfind" output).
+//------------------------------------------------------------------------------
+class CompactPath
+{
+public:
+    static const size_t steps_per_word = 21;
+    static const size_t nr_inline_words = 2;
+    static const size_t nr_inline_steps = steps_per_word * nr_inline_words;
+
+    class Iterator
+    {
+    public:
+        Iterator(const CompactPath& path, const size_t step_idx, const P& p) :
+            path_       (&path),
+            step_idx_   (step_idx),
+            p_          (p) {}
+
+        const P& operator*() const
+        {
+            return p_;
+        }
+
+        const P* operator->() const
+        {
+            return &p_;
+        }
+
+        Iterator& operator++()
+        {
+            ++step_idx_;
+
+            if (step_idx_ < path_->end_idx_)
+            {
+                p_ += path_->offset_at(step_idx_);
+            }
+
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const
+        {
+            return step_idx_ == other.step_idx_;
+        }
+
+        bool operator!=(const Iterator& other) const
+        {
+            return step_idx_ != other.step_idx_;
+        }
+
+    private:
+        const CompactPath* path_;
+        size_t step_idx_;
+        P p_;
+    };
+
+    CompactPath();
+
+    // Converts a path from "pathfind" (target to origin, not including the
+    // origin). All positions must be adjacent to the previous one.
+    CompactPath(const P& p0, const std::vector<P>& path);
+
+    CompactPath(const CompactPath& other);
+
+    CompactPath(CompactPath&& other) noexcept;
+
+    ~CompactPath();
+
+    CompactPath& operator=(const CompactPath& other);
+
+    CompactPath& operator=(CompactPath&& other) noexcept;
+
+    // Removes all steps, and sets a new origin
+    void clear(const P& p0);
+
+    // Adds a step at the end of the path (must not be "Dir::center")
+    void push_back(const Dir dir);
+
+    // Removes the first step, the origin is moved to the first position
+    void pop_front();
+
+    bool empty() const
+    {
+        return first_idx_ == end_idx_;
+    }
+
+    size_t size() const
+    {
+        return end_idx_ - first_idx_;
+    }
+
+    // The current origin (e.g. the position of a monster walking the path)
+    const P& origin() const
+    {
+        return origin_;
+    }
+
+    // NOTE: The path must not be empty
+    P front() const
+    {
+        return origin_ + offset_at(first_idx_);
+    }
+
+    // NOTE: The path must not be empty
+    Dir front_dir() const;
+
+    const P& target() const
+    {
+        return target_;
+    }
+
+    Iterator begin() const
+    {
+        return
+            empty() ?
+            end() :
+            Iterator(*this, first_idx_, front());
+    }
+
+    Iterator end() const
+    {
+        return Iterator(*this, end_idx_, target_);
+    }
+
+    // Converts to the "pathfind" format (target to origin, not including the
+    // origin)
+    void to_vec(std::vector<P>& out) const;
+
+private:
+    uint64_t* words()
+    {
+        return is_on_heap() ? heap_words_ : inline_words_;
+    }
+
+    const uint64_t* words() const
+    {
+        return is_on_heap() ? heap_words_ : inline_words_;
+    }
+
+    bool is_on_heap() const
+    {
+        return capacity_ > nr_inline_steps;
+    }
+
+    int code_at(const size_t step_idx) const
+    {
+        const uint64_t word = words()[step_idx / steps_per_word];
+
+        return (int)((word >> ((step_idx % steps_per_word) * 3)) & 7);
+    }
+
+    const P& offset_at(const size_t step_idx) const
+    {
+        return dir_utils::dir_list[code_at(step_idx)];
+    }
+
+    void copy_from(const CompactPath& other);
+
+    void steal_from(CompactPath& other);
+
+    void free_heap();
+
+    P origin_;
+    P target_;
+    size_t first_idx_;
+    size_t end_idx_;
+    size_t capacity_;
+
+    union
+    {
+        uint64_t inline_words_[nr_inline_words];
+        uint64_t* heap_words_;
+    };
+};
+
+#endif // RL_UTILS_COMPACT_PATH_HPP
@@ -0,0 +1,161 @@
+#ifndef RL_UTILS_COOP_PATHFIND_HPP
+#define RL_UTILS_COOP_PATHFIND_HPP
+
+#include <vector>
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+// Reservations of map cells for each of the next few turns (turn 0 is the
+// current turn), i.e. which agent will stand in a cell at a certain time.
+// Clearing all reservations is cheap (values are stamped with a generation,
+// similar to SearchCtx).
+//------------------------------------------------------------------------------
+class ReservationTable
+{
+public:
+    ReservationTable(const int nr_turns);
+
+    void clear();
+
+    void reserve(const P& p, const int t, const int agent_id);
+
+    void release(const P& p, const int t);
+
+    // Returns -1 if the cell is not reserved at this time
+    int owner(const P& p, const int t) const
+    {
+        const size_t idx = (t * nr_map_cells) + (p.x * map_h) + p.y;
+
+        return
+            (gen_stamps_[idx] == gen_) ?
+            owners_[idx] :
+            -1;
+    }
+
+    // Number of turns after the current turn
+    int nr_turns() const
+    {
+        return nr_turns_;
+    }
+
+private:
+    int nr_turns_;
+    uint32_t gen_;
+    std::vector<uint32_t> gen_stamps_;
+    std::vector<int> owners_;
+};
+
+//------------------------------------------------------------------------------
+// Windowed cooperative pathfinding ("WHCA*") - plans collision free moves for
+// a group of agents over the next "window" turns. The agents are planned one
+// at a time in the order given (earlier agents have priority), each with an A*
+// search over positions and time which avoids the cells reserved by the agents
+// planned before it (including two agents swapping places). Waiting in place
+// is a valid move.
+//
+// The true walking distance to the target (a floodfill from the target) is
+// used as heuristic, so the agents keep heading the right way beyond the
+// window. These floodfills are cached between calls, so as long as the
+// targets and map are unchanged, the cost per call only depends on the window
+// size and number of agents. Call "bump_revision" when the map changes.
+//
+// Each path in "out" corresponds to the request with the same index, and has
+// the same format as for "pathfind" (target to origin, not including the
+// origin), but with one position per turn - waiting gives the same position
+// again. The path ends after at most "window" turns (the last position is the
+// first element), or when the agent has reached its target and waits there.
+// Agents which cannot reach their target, or which are boxed in by the other
+// agents, get an empty path (and are expected to stand still).
+//
+// Each agent keeps its current cell reserved for the next turn until it has
+// been planned, and only gives it up if it finds a path. If an agent is boxed
+// in after an earlier agent planned to step into its cell, the planning is
+// redone from the start with the boxed in agent standing still for the whole
+// window - so an agent with an empty path never shares its cell with another
+// agent.
+//
+// This is meant to be called again every turn (or every few turns), with the
+// current positions of the agents.
+//
+// NOTE: The blocked cells should not include the agents themselves (e.g.
+// monsters), since this is handled by the reservations.
+//------------------------------------------------------------------------------
+class CoopPathfinder
+{
+public:
+    CoopPathfinder(const int window, const size_t max_nr_target_floods = 64);
+
+    void pathfind(const std::vector<PathReq>& reqs,
+                  const bool blocked[map_w][map_h],
+                  std::vector< std::vector<P> >& out,
+                  const bool allow_diagonal = true);
+
+    void bump_revision()
+    {
+        ++revision_;
+
+        // Old floods would never be evicted from an unbounded cache
+        if (target_floods_.max_size() == 0)
+        {
+            target_floods_.clear();
+        }
+    }
+
+    // The reservations made by the latest call to "pathfind"
+    const ReservationTable& reservations() const
+    {
+        return reservations_;
+    }
+
+private:
+    struct Key
+    {
+        Key(const P& p,
+            const bool allow_diagonal,
+            const uint32_t revision) :
+            p               (p),
+            allow_diagonal  (allow_diagonal),
+            revision        (revision) {}
+
+        bool operator==(const Key& other) const
+        {
+            return
+                (p == other.p) &&
+                (allow_diagonal == other.allow_diagonal) &&
+                (revision == other.revision);
+        }
+
+        P p;
+        bool allow_diagonal;
+        uint32_t revision;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    const std::vector<int>& target_flood(const P& p1,
+                                         const bool blocked[map_w][map_h],
+                                         const bool allow_diagonal);
+
+    bool pathfind_agent(const int agent_id,
+                        const PathReq& req,
+                        const std::vector<int>& flood,
+                        const bool blocked[map_w][map_h],
+                        std::vector<P>& out,
+                        const bool allow_diagonal);
+
+    const int window_;
+    uint32_t revision_;
+    ReservationTable reservations_;
+    LruCache<Key, std::vector<int>, KeyHash> target_floods_;
+
+    // Search buffers, one value per position and time
+    uint32_t search_gen_;
+    std::vector<uint32_t> search_gen_stamps_;
+    std::vector<int> search_g_;
+    std::vector<int> search_parents_;
+};
+
+#endif // RL_UTILS_COOP_PATHFIND_HPP
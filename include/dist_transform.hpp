@@ -0,0 +1,26 @@
+#ifndef RL_UTILS_DIST_TRANSFORM_HPP
+#define RL_UTILS_DIST_TRANSFORM_HPP
+
+enum class DistMetric
+{
+    king,           // As "king_dist"
+    taxi,           // As "taxi_dist"
+    euclidean_sq    // Squared euclidean distance
+};
+
+//------------------------------------------------------------------------------
+// Distance transform - sets each cell to the distance to the nearest feature
+// cell (e.g. "distance to nearest wall", if walls are the feature cells). The
+// distances are straight distances which do not consider obstacles, use a
+// floodfill for walking distances.
+//
+// This runs in linear time, regardless of the number of feature cells. If there
+// are no feature cells at all, all cells are set to -1.
+//
+// Map arrays and Array2 can be passed directly (see GridView).
+//------------------------------------------------------------------------------
+void dist_transform(const GridView<const bool>& features,
+                    const GridView<int>& out,
+                    const DistMetric metric);
+
+#endif // RL_UTILS_DIST_TRANSFORM_HPP
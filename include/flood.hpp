@@ -1,11 +1,173 @@
 #ifndef RL_UTILS_FLOOD_HPP
 #define RL_UTILS_FLOOD_HPP
 
+class SearchCtx;
+
+void floodfill(const P& p0,
+               const bool blocked[map_w][map_h],
+               int out[map_w][map_h],
+               int travel_lmt = -1,
+               const P& p1 = P(-1, -1),
+               const bool allow_diagonal = true);
+
+// Same as above, but for a grid of any size (e.g. a part of the map, or a map of
+// a different size than the standard map). Positions are relative to the grid,
+// and all cells of the grid can be flooded (including the outermost cells).
 void floodfill(const P& p0,
+               const GridView<const bool>& blocked,
+               const GridView<int>& out,
+               int travel_lmt = -1,
+               const P& p1 = P(-1, -1),
+               const bool allow_diagonal = true);
+
+// Same as the first version, but reuses the buffers in "ctx" instead of
+// allocating memory.
+//
+// NOTE: This is still O(map) per call, since the whole output array must be
+// cleared (it may hold values from any earlier use) - use the version below
+// to only touch the cells which are reached.
+void floodfill(SearchCtx& ctx,
+               const P& p0,
                const bool blocked[map_w][map_h],
                int out[map_w][map_h],
                int travel_lmt = -1,
                const P& p1 = P(-1, -1),
                const bool allow_diagonal = true);
 
+// Same as above, but the result is stored in "ctx" (see "SearchCtx::val"), so
+// no output array needs to be cleared
+void floodfill(SearchCtx& ctx,
+               const P& p0,
+               const bool blocked[map_w][map_h],
+               int travel_lmt = -1,
+               const P& p1 = P(-1, -1),
+               const bool allow_diagonal = true);
+
+//------------------------------------------------------------------------------
+// Same result as "floodfill", but the free cells of each row are packed into
+// bits, and the whole frontier is expanded one step at a time using word-wide
+// shift/and/or operations instead of visiting one position at a time. This is
+// much faster for large open maps.
+//
+// NOTE: When stopping at a target, all cells at the same distance as the
+// target are filled in (the normal floodfill stops as soon as the target is
+// found), which makes no difference for pathfinding.
+//------------------------------------------------------------------------------
+void floodfill_bitwise(const P& p0,
+                       const bool blocked[map_w][map_h],
+                       int out[map_w][map_h],
+                       int travel_lmt = -1,
+                       const P& p1 = P(-1, -1),
+                       const bool allow_diagonal = true);
+
+//------------------------------------------------------------------------------
+// Floodfill where entering each cell has a cost (e.g. higher for swamps or
+// doors), so the resulting values are the lowest total cost from the origin
+// instead of the number of steps. Cells with a cost below one are treated as
+// blocked. The costs are expected to be small integers, since a bucket queue
+// with one bucket per cost value is used (this runs in near linear time).
+//
+// The output can be passed to "pathfind_with_flood" to get the cheapest path.
+//------------------------------------------------------------------------------
+void floodfill_weighted(const P& p0,
+                        const int cost[map_w][map_h],
+                        int out[map_w][map_h],
+                        int travel_lmt = -1,
+                        const P& p1 = P(-1, -1),
+                        const bool allow_diagonal = true);
+
+//------------------------------------------------------------------------------
+// Floodfill from multiple origins at once, in a single pass. Each cell gets the
+// number of steps to the nearest origin (this is the basis of "Dijkstra maps").
+// As for the normal floodfill, the origins and unreached cells are zero.
+//------------------------------------------------------------------------------
+void floodfill_multi(const std::vector<P>& origins,
+                     const bool blocked[map_w][map_h],
+                     int out[map_w][map_h],
+                     int travel_lmt = -1,
+                     const bool allow_diagonal = true);
+
+// Same as above, but each origin has a starting value, so that e.g. a more
+// desirable target can count as being closer. The resulting value of each cell
+// is the lowest starting value plus number of steps over all origins.
+//
+// If "nearest_origin" is not null, it is set to the index in "origins" of the
+// origin which produced the value of each cell, or -1 for unreached cells.
+void floodfill_multi(const std::vector<PosVal>& origins,
+                     const bool blocked[map_w][map_h],
+                     int out[map_w][map_h],
+                     int nearest_origin[map_w][map_h],
+                     int travel_lmt = -1,
+                     const bool allow_diagonal = true);
+
+//------------------------------------------------------------------------------
+// Radius bounded floodfill, for many small floods (e.g. sounds or smells). The
+// values are stored in a local grid covering only the cells within
+// "travel_lmt" steps of the origin, so the cost depends on the radius instead
+// of the map size. The buffers are kept between calls, so reusing the same
+// LocalFlood object does not allocate memory.
+//------------------------------------------------------------------------------
+class LocalFlood
+{
+public:
+    LocalFlood() :
+        r_(P(0, 0), P(-1, -1)) {}
+
+    // The area covered by the local grid, in map coordinates
+    const R& r() const
+    {
+        return r_;
+    }
+
+    // Map position of the first cell in the local grid
+    const P& offset() const
+    {
+        return r_.p0;
+    }
+
+    // Value at a map position, zero outside the local grid
+    int val(const P& p) const
+    {
+        if (!r_.is_p_inside(p))
+        {
+            return 0;
+        }
+
+        return vals_[((p.x - r_.p0.x) * r_.h()) + (p.y - r_.p0.y)];
+    }
+
+    void set_val(const P& p, const int v)
+    {
+        vals_[((p.x - r_.p0.x) * r_.h()) + (p.y - r_.p0.y)] = v;
+    }
+
+    // The local grid, where local position (0, 0) is "offset()" on the map
+    GridView<const int> view() const
+    {
+        return GridView<const int>(vals_.data(), r_.dims(), r_.h());
+    }
+
+    // Sets up the local grid to cover "r" (in map coordinates), with all
+    // values set to zero
+    void reset(const R& r);
+
+    std::vector<P>& positions()
+    {
+        return positions_;
+    }
+
+private:
+    R r_;
+    std::vector<int> vals_;
+    std::vector<P> positions_;
+};
+
+// NOTE: "travel_lmt" must be zero or higher
+void floodfill_local(const P& p0,
+                     const bool blocked[map_w][map_h],
+                     LocalFlood& out,
+                     int travel_lmt,
+                     const P& p1 = P(-1, -1),
+                     const bool allow_diagonal = true);
+
 #endif // RL_UTILS_FLOOD_HPP
@@ -0,0 +1,68 @@
+#ifndef RL_UTILS_FLOOD_FIELD_HPP
+#define RL_UTILS_FLOOD_FIELD_HPP
+
+//------------------------------------------------------------------------------
+// A floodfill result which is kept up to date as cells become blocked or free
+// (e.g. when a door is opened or a wall is dug out). Only the distances that
+// are affected by a change are recalculated, instead of the whole map.
+//
+// The values have the same format as for "floodfill" (i.e. zero for the origin
+// and for unreached cells), so they can be passed to "pathfind_with_flood".
+//------------------------------------------------------------------------------
+class FloodField
+{
+public:
+    FloodField(const P& p0,
+               const bool blocked[map_w][map_h],
+               const bool allow_diagonal = true);
+
+    // Sets the blocked state of a cell, and repairs the affected distances
+    void set_blocked(const P& p, const bool is_blocked);
+
+    bool is_blocked(const P& p) const
+    {
+        return blocked_[p.x][p.y];
+    }
+
+    const P& origin() const
+    {
+        return p0_;
+    }
+
+    int val(const P& p) const
+    {
+        return flood_[p.x][p.y];
+    }
+
+    const int (&flood() const)[map_w][map_h]
+    {
+        return flood_;
+    }
+
+private:
+    bool is_reached(const P& p) const
+    {
+        return (p == p0_) || (flood_[p.x][p.y] != 0);
+    }
+
+    bool can_flood_to(const P& p) const;
+
+    // Sets the cell to one step more than its lowest reached neighbour (if any
+    // neighbour is reached), returns true if the cell was reached this way
+    bool set_from_adj(const P& p);
+
+    // Floods out from the given (already assigned) cells, and lowers the value
+    // of any cell which can be reached in fewer steps
+    void flood_from(std::vector<P>& seeds);
+
+    void on_blocked(const P& p);
+
+    void on_unblocked(const P& p);
+
+    const P p0_;
+    const std::vector<P>& dirs_;
+    bool blocked_[map_w][map_h];
+    int flood_[map_w][map_h];
+};
+
+#endif // RL_UTILS_FLOOD_FIELD_HPP
@@ -0,0 +1,95 @@
+#ifndef RL_UTILS_FLOOD_POOL_HPP
+#define RL_UTILS_FLOOD_POOL_HPP
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+//------------------------------------------------------------------------------
+// Parameters and output for one floodfill in a batch (see "floodfill")
+//------------------------------------------------------------------------------
+struct FloodReq
+{
+    FloodReq() :
+        p0              (),
+        out             (nullptr),
+        travel_lmt      (-1),
+        p1              (-1, -1),
+        allow_diagonal  (true) {}
+
+    FloodReq(const P& p0,
+             int out[map_w][map_h],
+             const int travel_lmt = -1,
+             const P& p1 = P(-1, -1),
+             const bool allow_diagonal = true) :
+        p0              (p0),
+        out             (out),
+        travel_lmt      (travel_lmt),
+        p1              (p1),
+        allow_diagonal  (allow_diagonal) {}
+
+    P p0;
+    int (*out)[map_h];
+    int travel_lmt;
+    P p1;
+    bool allow_diagonal;
+};
+
+//------------------------------------------------------------------------------
+// Runs batches of independent floodfills on several threads. The threads are
+// kept between batches, and each thread has its own search buffers, so the
+// only shared state is the index of the next floodfill to run. The calling
+// thread also takes part in the work.
+//
+// NOTE: The output arrays of the floodfills in a batch must all be different.
+// NOTE: The user project must link with the platform threading library (e.g.
+//       "-pthread").
+//------------------------------------------------------------------------------
+class FloodPool
+{
+public:
+    // Zero means one thread less than the number of hardware threads (since
+    // the calling thread also runs floodfills)
+    FloodPool(const int nr_threads = 0);
+
+    ~FloodPool();
+
+    FloodPool(const FloodPool&) = delete;
+
+    FloodPool& operator=(const FloodPool&) = delete;
+
+    // Runs all floodfills in the batch, and returns when all are done
+    void run(const std::vector<FloodReq>& reqs,
+             const bool blocked[map_w][map_h]);
+
+private:
+    void worker_loop(const size_t worker_idx);
+
+    void run_reqs(SearchCtx& ctx);
+
+    std::vector<std::thread> threads_;
+
+    // One per thread, plus one for the calling thread
+    std::vector< std::unique_ptr<SearchCtx> > ctxs_;
+
+    std::mutex mutex_;
+    std::condition_variable work_cond_;
+    std::condition_variable done_cond_;
+    uint64_t batch_nr_;
+    size_t nr_threads_done_;
+    bool is_stopping_;
+
+    const std::vector<FloodReq>* reqs_;
+    const bool (*blocked_)[map_h];
+    std::atomic<size_t> next_req_idx_;
+};
+
+// Runs a batch of floodfills on a temporary FloodPool
+void floodfill_batch(const std::vector<FloodReq>& reqs,
+                     const bool blocked[map_w][map_h],
+                     const int nr_threads = 0);
+
+#endif // RL_UTILS_FLOOD_POOL_HPP
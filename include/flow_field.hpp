@@ -0,0 +1,31 @@
+#ifndef RL_UTILS_FLOW_FIELD_HPP
+#define RL_UTILS_FLOW_FIELD_HPP
+
+//------------------------------------------------------------------------------
+// Flow field - converts a floodfill from a goal position into a grid of
+// directions, where each cell points at the next step towards the goal. This
+// lets any number of monsters share one search, where each move is just a
+// lookup (e.g. "p += dirs[p.x][p.y]").
+//
+// The steps are chosen in the same way as in "pathfind_with_flood()", i.e.
+// following a cell direction from any reached cell gives the same path as
+// pathfinding from that cell (with "randomize_steps" false). This also works
+// with a weighted floodfill.
+//
+// The goal cell, and cells not reached by the floodfill, are set to
+// "Dir::center".
+//
+// "randomize_steps", when true, picks a random direction (using the "rnd"
+// functions) when there are multiple equally good choices. Otherwise the first
+// valid direction in "dir_utils::dir_list" is used.
+//
+// Map arrays and Array2 can be passed directly (see GridView).
+//------------------------------------------------------------------------------
+void flow_field(
+    const P& goal,                          // Origin of the floodfill
+    const GridView<const int>& flood,       // Floodfill from the goal
+    const GridView<Dir>& out,               // Result
+    const bool allow_diagonal = true,       // Cardinals only?
+    const bool randomize_steps = false);    // See above
+
+#endif // RL_UTILS_FLOW_FIELD_HPP
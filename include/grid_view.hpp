@@ -0,0 +1,116 @@
+#ifndef RL_UTILS_GRID_VIEW_HPP
+#define RL_UTILS_GRID_VIEW_HPP
+
+#include <type_traits>
+
+#include "pos.hpp"
+#include "rect.hpp"
+#include "array2.hpp"
+
+//------------------------------------------------------------------------------
+// Non-owning view of a two dimensional grid of any size, such as a map array,
+// an Array2, or a part of either. The elements are stored column by column
+// (same as for map arrays and Array2 with the default layout), and "stride" is
+// the distance between the first elements of two neighbouring columns.
+//------------------------------------------------------------------------------
+template<typename T>
+class GridView
+{
+public:
+    GridView(T* data, const P& dims, const int stride) :
+        data_   (data),
+        dims_   (dims),
+        stride_ (stride) {}
+
+    // View of a whole map array
+    GridView(T (*a)[map_h]) :
+        data_   (*a),
+        dims_   (map_w, map_h),
+        stride_ (map_h) {}
+
+    GridView(Array2<typename std::remove_const<T>::type, ColMajorLayout>& a) :
+        data_   (a.data()),
+        dims_   (a.dims()),
+        stride_ (a.dims().y) {}
+
+    GridView(
+        const Array2<typename std::remove_const<T>::type, ColMajorLayout>& a) :
+        data_   (a.data()),
+        dims_   (a.dims()),
+        stride_ (a.dims().y) {}
+
+    // NOTE: Only column major Array2 can be viewed - other layouts are
+    // rejected here (and are not convertible to GridView)
+    template<typename Layout>
+    GridView(Array2<typename std::remove_const<T>::type, Layout>& a) = delete;
+
+    template<typename Layout>
+    GridView(
+        const Array2<typename std::remove_const<T>::type, Layout>& a) = delete;
+
+    operator GridView<const T>() const
+    {
+        return GridView<const T>(data_, dims_, stride_);
+    }
+
+    // View of a part of this view, positions in the new view are relative to
+    // the top left corner of the area
+    GridView<T> sub(const R& area) const
+    {
+        ASSERT(is_p_inside(area.p0));
+        ASSERT(is_p_inside(area.p1));
+
+        return GridView<T>(&(*this)(area.p0), area.dims(), stride_);
+    }
+
+    T& operator()(const P& p) const
+    {
+        ASSERT(is_p_inside(p));
+
+        return data_[(p.x * stride_) + p.y];
+    }
+
+    T& operator()(const int x, const int y) const
+    {
+        return (*this)(P(x, y));
+    }
+
+    bool is_p_inside(const P& p) const
+    {
+        return
+            (p.x >= 0) &&
+            (p.y >= 0) &&
+            (p.x < dims_.x) &&
+            (p.y < dims_.y);
+    }
+
+    void fill(const T& v) const
+    {
+        for (int x = 0; x < dims_.x; ++x)
+        {
+            std::fill_n(data_ + (x * stride_), dims_.y, v);
+        }
+    }
+
+    T* data() const
+    {
+        return data_;
+    }
+
+    const P& dims() const
+    {
+        return dims_;
+    }
+
+    int stride() const
+    {
+        return stride_;
+    }
+
+private:
+    T* data_;
+    P dims_;
+    int stride_;
+};
+
+#endif // RL_UTILS_GRID_VIEW_HPP
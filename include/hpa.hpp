@@ -0,0 +1,141 @@
+#ifndef RL_UTILS_HPA_HPP
+#define RL_UTILS_HPA_HPP
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Hierarchical pathfinding (HPA*), for long distance travel on big maps. The
+// map is split into square clusters, with nodes at the entrances between
+// neighbouring clusters, and the step counts between the nodes within each
+// cluster are calculated beforehand. A search is then done on this small graph
+// of entrances, and only the parts of the path which are actually walked need
+// to be refined into single steps.
+//
+// The paths are close to the shortest possible, but not guaranteed to be.
+//------------------------------------------------------------------------------
+class HpaGraph
+{
+public:
+    HpaGraph(const bool blocked[map_w][map_h],
+             const int cluster_size = 10,
+             const bool allow_diagonal = true);
+
+    HpaGraph(const HpaGraph&) = delete;
+
+    HpaGraph& operator=(const HpaGraph&) = delete;
+
+    // Updates the blocked cells of the cluster containing "p" from "blocked",
+    // and rebuilds the entrances and distances affected by this cluster
+    void rebuild_cluster(const P& p, const bool blocked[map_w][map_h]);
+
+    // Finds the waypoints to travel between, from origin to target (including
+    // both). Each pair of consecutive waypoints can be passed to "refine" to get
+    // the steps between them. Returns false if there is no path.
+    bool pathfind_abstract(const P& p0,
+                           const P& p1,
+                           std::vector<P>& out);
+
+    // Steps from waypoint "p0" to waypoint "p1", in the same format as for
+    // "pathfind" (from "p1" to "p0", not including "p0")
+    void refine(const P& p0, const P& p1, std::vector<P>& out);
+
+    // Finds and refines a whole path, in the same format as for "pathfind"
+    void pathfind(const P& p0, const P& p1, std::vector<P>& out);
+
+    size_t nr_nodes() const
+    {
+        return nodes_.size() - free_node_idxs_.size();
+    }
+
+private:
+    struct Edge
+    {
+        Edge(const int node_idx, const int cost, const bool is_inter) :
+            node_idx    (node_idx),
+            cost        (cost),
+            is_inter    (is_inter) {}
+
+        int node_idx;
+        int cost;
+
+        // Between clusters (otherwise within the same cluster)
+        bool is_inter;
+    };
+
+    struct Node
+    {
+        Node() :
+            p           (),
+            cluster_idx (-1),
+            is_alive    (false),
+            edges       () {}
+
+        P p;
+        int cluster_idx;
+        bool is_alive;
+        std::vector<Edge> edges;
+    };
+
+    int cluster_idx(const P& p) const
+    {
+        return
+            ((p.y / cluster_size_) * nr_clusters_x_) +
+            (p.x / cluster_size_);
+    }
+
+    P cluster_pos(const int cluster_idx) const
+    {
+        return P(cluster_idx % nr_clusters_x_,
+                 cluster_idx / nr_clusters_x_);
+    }
+
+    // Cluster position to cluster index, or -1 if outside the map
+    int cluster_idx_at(const P& cluster_p) const;
+
+    R cluster_r(const int cluster_idx) const;
+
+    bool is_free(const P& p) const;
+
+    // Sets the mask to the blocked cells of the cluster (so searches are kept
+    // within it), or blocks all cells of the cluster
+    void set_cluster_masked(const int cluster_idx, const bool is_masked);
+
+    // Returns an existing node at the position, or adds a new one
+    int add_node(const P& p);
+
+    void remove_node(const int node_idx);
+
+    // Removes the transitions between two clusters, and any nodes left without
+    // transitions
+    void remove_transitions(const int cluster_idx_0, const int cluster_idx_1);
+
+    void add_transition(const P& p0, const P& p1);
+
+    // "cluster_idx_1" is to the right of, or below "cluster_idx_0"
+    void add_border_transitions(const int cluster_idx_0,
+                                const int cluster_idx_1);
+
+    // "cluster_idx_1" is diagonally below "cluster_idx_0"
+    void add_corner_transition(const int cluster_idx_0,
+                               const int cluster_idx_1);
+
+    // Adds all transitions between the cluster and the neighbouring cluster at
+    // the given cluster offset (if any)
+    void add_transitions_to(const int cluster_idx, const P& offset);
+
+    // Recalculates the distances between the nodes in the cluster
+    void connect_cluster(const int cluster_idx);
+
+    const int cluster_size_;
+    const int nr_clusters_x_;
+    const int nr_clusters_y_;
+    const bool allow_diagonal_;
+    std::vector<Node> nodes_;
+    std::vector<int> free_node_idxs_;
+    std::vector< std::vector<int> > cluster_nodes_;
+    bool blocked_[map_w][map_h];
+    bool mask_[map_w][map_h];
+    SearchCtx ctx_;
+};
+
+#endif // RL_UTILS_HPA_HPP
@@ -24,6 +24,10 @@ int constr_in_range(const double min,
 std::vector<P> to_vec(const bool a[map_w][map_h],
                       const bool value_to_store);
 
+// Same as above, but for a grid of any size (positions are relative to the grid)
+std::vector<P> to_vec(const GridView<const bool>& a,
+                      const bool value_to_store);
+
 bool is_pos_inside(const P& pos, const R& area);
 
 bool is_area_inside(const R& inner,
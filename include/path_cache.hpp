@@ -0,0 +1,232 @@
+#ifndef RL_UTILS_PATH_CACHE_HPP
+#define RL_UTILS_PATH_CACHE_HPP
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+class R;
+
+//------------------------------------------------------------------------------
+// Least recently used cache, evicting the oldest entries when full
+//------------------------------------------------------------------------------
+template<typename K, typename V, typename Hash>
+class LruCache
+{
+public:
+    // NOTE: A "max_size" of zero means that the cache is unbounded (entries
+    // are never evicted)
+    LruCache(const size_t max_size) :
+        max_size_   (max_size) {}
+
+    // Returns null if there is no such entry, otherwise the entry is marked as
+    // the most recently used
+    V* find(const K& key)
+    {
+        auto it = map_.find(key);
+
+        if (it == end(map_))
+        {
+            return nullptr;
+        }
+
+        entries_.splice(begin(entries_), entries_, it->second);
+
+        return &it->second->second;
+    }
+
+    V& insert(const K& key, V&& val)
+    {
+        auto it = map_.find(key);
+
+        if (it != end(map_))
+        {
+            entries_.erase(it->second);
+
+            map_.erase(it);
+        }
+        else if ((max_size_ > 0) && (map_.size() >= max_size_))
+        {
+            map_.erase(entries_.back().first);
+
+            entries_.pop_back();
+        }
+
+        entries_.emplace_front(key, std::move(val));
+
+        map_[key] = begin(entries_);
+
+        return entries_.front().second;
+    }
+
+    template<typename Pred>
+    void erase_if(Pred pred)
+    {
+        for (auto it = begin(entries_); it != end(entries_); )
+        {
+            if (pred(it->first, it->second))
+            {
+                map_.erase(it->first);
+
+                it = entries_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void clear()
+    {
+        map_.clear();
+
+        entries_.clear();
+    }
+
+    size_t size() const
+    {
+        return map_.size();
+    }
+
+    size_t max_size() const
+    {
+        return max_size_;
+    }
+
+private:
+    typedef std::list< std::pair<K, V> > Entries;
+
+    const size_t max_size_;
+    Entries entries_;
+    std::unordered_map<K, typename Entries::iterator, Hash> map_;
+};
+
+//------------------------------------------------------------------------------
+// Cache for paths and floodfills, for when the same searches are repeated over
+// several turns while the map is unchanged. The results are stored together
+// with a map revision number - call "bump_revision" whenever the map changes
+// (this is very cheap, old results are simply never used again, and are
+// eventually evicted - or cleared right away if the cache is unbounded). For
+// small changes, "invalidate_area" can be used instead, to only throw away the
+// results which are affected.
+//
+// NOTE: The blocked cells passed in must always correspond to the current
+// revision, the cache has no way of detecting map changes by itself.
+//------------------------------------------------------------------------------
+struct CacheStats
+{
+    CacheStats() :
+        nr_hits     (0),
+        nr_misses   (0) {}
+
+    size_t nr_hits;
+    size_t nr_misses;
+};
+
+class PathCache
+{
+public:
+    // A max number of zero means that there is no limit (see "LruCache")
+    PathCache(const size_t max_nr_paths, const size_t max_nr_floods);
+
+    // Same as "pathfind" (step choices are never randomized)
+    void pathfind(const P& p0,
+                  const P& p1,
+                  const bool blocked[map_w][map_h],
+                  std::vector<P>& out,
+                  const bool allow_diagonal = true);
+
+    // Same as "floodfill" (without travel limit or target)
+    void floodfill(const P& p0,
+                   const bool blocked[map_w][map_h],
+                   int out[map_w][map_h],
+                   const bool allow_diagonal = true);
+
+    void bump_revision()
+    {
+        ++revision_;
+
+        // Old results would never be evicted from an unbounded cache
+        if (paths_.max_size() == 0)
+        {
+            paths_.clear();
+        }
+
+        if (floods_.max_size() == 0)
+        {
+            floods_.clear();
+        }
+    }
+
+    uint32_t revision() const
+    {
+        return revision_;
+    }
+
+    // Throws away all floodfills which reached the area (or which could now
+    // reach into the area), all paths which start, end or go through the area
+    // or next to it, and all "no path" results (since unblocking cells in the
+    // area could connect them). The remaining paths can still be walked, but
+    // if cells were unblocked in the area there could now be a shorter path -
+    // bump the revision instead if this matters.
+    void invalidate_area(const R& area);
+
+    void clear();
+
+    const CacheStats& path_stats() const
+    {
+        return path_stats_;
+    }
+
+    const CacheStats& flood_stats() const
+    {
+        return flood_stats_;
+    }
+
+    void reset_stats()
+    {
+        path_stats_ = CacheStats();
+        flood_stats_ = CacheStats();
+    }
+
+private:
+    struct Key
+    {
+        Key(const P& p0,
+            const P& p1,
+            const bool allow_diagonal,
+            const uint32_t revision) :
+            p0              (p0),
+            p1              (p1),
+            allow_diagonal  (allow_diagonal),
+            revision        (revision) {}
+
+        bool operator==(const Key& other) const
+        {
+            return
+                (p0 == other.p0) &&
+                (p1 == other.p1) &&
+                (allow_diagonal == other.allow_diagonal) &&
+                (revision == other.revision);
+        }
+
+        P p0;
+        P p1;
+        bool allow_diagonal;
+        uint32_t revision;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    uint32_t revision_;
+    LruCache<Key, std::vector<P>, KeyHash> paths_;
+    LruCache<Key, std::vector<int>, KeyHash> floods_;
+    CacheStats path_stats_;
+    CacheStats flood_stats_;
+};
+
+#endif // RL_UTILS_PATH_CACHE_HPP
@@ -0,0 +1,28 @@
+#ifndef RL_UTILS_PATH_SMOOTH_HPP
+#define RL_UTILS_PATH_SMOOTH_HPP
+
+//------------------------------------------------------------------------------
+// Path smoothing ("string pulling") - reduces a path to a few waypoints, where
+// there is a clear line (see "bresenham") between each waypoint and the next.
+// This removes the zig-zag steps from e.g. "pathfind_with_flood", and the
+// waypoints are much cheaper to store than the full path.
+//
+// The path and waypoints use the same format as the "pathfind" output, i.e.
+// they go from target to origin, not including the origin (so the origin must
+// be passed separately). The target is always the first waypoint.
+//
+// NOTE: The lines between the waypoints may contain diagonal steps, even if the
+// original path only had cardinal steps.
+//------------------------------------------------------------------------------
+void smooth_path(const P& p0,                       // Origin
+                 const std::vector<P>& path,        // Path to smooth
+                 const bool blocked[map_w][map_h],  // Blocked cells
+                 std::vector<P>& out);              // Waypoints
+
+// Converts waypoints back to a path with one position per step, by following
+// the same lines which were checked by "smooth_path"
+void expand_waypoints(const P& p0,                  // Origin
+                      const std::vector<P>& waypoints,
+                      std::vector<P>& out);         // Path
+
+#endif // RL_UTILS_PATH_SMOOTH_HPP
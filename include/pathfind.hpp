@@ -1,6 +1,8 @@
 #ifndef RL_UTILS_PATHFIND_HPP
 #define RL_UTILS_PATHFIND_HPP
 
+class SearchCtx;
+
 //------------------------------------------------------------------------------
 // The path goes from target to origin, not including the origin.
 //
@@ -18,6 +20,30 @@ void pathfind(
     const bool allow_diagonal = true,       // Cardinals only?
     const bool randomize_steps = false);    // See above
 
+// Same as above, but reuses the buffers in "ctx" - this does not allocate any
+// memory (except for growing "out"), and does not clear a whole map array
+void pathfind(
+    SearchCtx& ctx,                         // Reused buffers
+    const P& p0,                            // Origin
+    const P& p1,                            // Target
+    const bool blocked[map_w][map_h],       // Blocked cells
+    std::vector<P>& out,                    // Result
+    const bool allow_diagonal = true,       // Cardinals only?
+    const bool randomize_steps = false);    // See above
+
+// Same as the first version, but for a grid of any size (e.g. a part of the map,
+// or a map of a different size than the standard map). Positions are relative
+// to the grid, and all cells of the grid can be entered (including the
+// outermost cells).
+void pathfind(
+    const P& p0,                            // Origin
+    const P& p1,                            // Target
+    const GridView<const bool>& blocked,    // Blocked cells
+    std::vector<P>& out,                    // Result
+    const bool allow_diagonal = true,       // Cardinals only?
+    const bool randomize_steps = false);    // See above
+
+// NOTE: This does not allocate any memory (except for growing "out")
 void pathfind_with_flood(
     const P& p0,                            // Origin
     const P& p1,                            // Target
@@ -26,4 +52,112 @@ void pathfind_with_flood(
     const bool allow_diagonal = true,       // Cardinals only?
     const bool randomize_steps = false);    // See above
 
+// Same as above, but for a grid of any size
+void pathfind_with_flood(
+    const P& p0,                            // Origin
+    const P& p1,                            // Target
+    const GridView<const int>& flood,       // Floodfill
+    std::vector<P>& out,                    // Result
+    const bool allow_diagonal = true,       // Cardinals only?
+    const bool randomize_steps = false);    // See above
+
+// Same as the first version, but for a floodfill stored in "ctx" (see
+// "SearchCtx::val")
+void pathfind_with_flood(
+    const P& p0,                            // Origin
+    const P& p1,                            // Target
+    const SearchCtx& ctx,                   // Floodfill
+    std::vector<P>& out,                    // Result
+    const bool allow_diagonal = true,       // Cardinals only?
+    const bool randomize_steps = false);    // See above
+
+//------------------------------------------------------------------------------
+// Same as "pathfind", but uses an A* search instead of a full floodfill. The
+// king distance is used as heuristic (or taxicab distance for cardinals only),
+// so only cells close to the straight line between origin and target are
+// expanded. This is much cheaper than "pathfind" for short paths on big maps.
+//------------------------------------------------------------------------------
+void pathfind_astar(
+    const P& p0,                            // Origin
+    const P& p1,                            // Target
+    const bool blocked[map_w][map_h],       // Blocked cells
+    std::vector<P>& out,                    // Result
+    const bool allow_diagonal = true,       // Cardinals only?
+    const bool randomize_steps = false);    // See "pathfind"
+
+// Same as above, but reuses the buffers in "ctx" (the version above uses the
+// context of the calling thread, see "thread_search_ctx")
+void pathfind_astar(
+    SearchCtx& ctx,                         // Reused buffers
+    const P& p0,                            // Origin
+    const P& p1,                            // Target
+    const bool blocked[map_w][map_h],       // Blocked cells
+    std::vector<P>& out,                    // Result
+    const bool allow_diagonal = true,       // Cardinals only?
+    const bool randomize_steps = false);    // See "pathfind"
+
+//------------------------------------------------------------------------------
+// Same as "pathfind", but uses Jump Point Search, which skips over most of the
+// cells that A* or a floodfill would evaluate on uniform-cost grids (such as
+// large open areas and long corridors). The resulting path is expanded to one
+// position per step, in the same format as for "pathfind". Step choices cannot
+// be randomized, since the path is built from straight lines between jump
+// points.
+//------------------------------------------------------------------------------
+void pathfind_jps(
+    const P& p0,                            // Origin
+    const P& p1,                            // Target
+    const bool blocked[map_w][map_h],       // Blocked cells
+    std::vector<P>& out,                    // Result
+    const bool allow_diagonal = true);      // Cardinals only?
+
+// Same as above, but reuses the buffers in "ctx" (the version above uses the
+// context of the calling thread, see "thread_search_ctx")
+void pathfind_jps(
+    SearchCtx& ctx,                         // Reused buffers
+    const P& p0,                            // Origin
+    const P& p1,                            // Target
+    const bool blocked[map_w][map_h],       // Blocked cells
+    std::vector<P>& out,                    // Result
+    const bool allow_diagonal = true);      // Cardinals only?
+
+//------------------------------------------------------------------------------
+// Finds paths for many origin/target pairs at once. Requests with the same
+// target share a single floodfill from that target (e.g. when many monsters
+// are moving towards the player), instead of one floodfill per origin.
+//
+// Each path in "out" corresponds to the request with the same index, and has
+// the same format as for "pathfind".
+//------------------------------------------------------------------------------
+struct PathReq
+{
+    PathReq() :
+        p0  (),
+        p1  () {}
+
+    PathReq(const P& p0, const P& p1) :
+        p0  (p0),
+        p1  (p1) {}
+
+    P p0; // Origin
+    P p1; // Target
+};
+
+void pathfind_batch(
+    const std::vector<PathReq>& reqs,       // Origins and targets
+    const bool blocked[map_w][map_h],       // Blocked cells
+    std::vector< std::vector<P> >& out,     // Result
+    const bool allow_diagonal = true,       // Cardinals only?
+    const bool randomize_steps = false);    // See "pathfind"
+
+// Same as above, but reuses the buffers in "ctx" (the version above uses the
+// context of the calling thread, see "thread_search_ctx")
+void pathfind_batch(
+    SearchCtx& ctx,                         // Reused buffers
+    const std::vector<PathReq>& reqs,       // Origins and targets
+    const bool blocked[map_w][map_h],       // Blocked cells
+    std::vector< std::vector<P> >& out,     // Result
+    const bool allow_diagonal = true,       // Cardinals only?
+    const bool randomize_steps = false);    // See "pathfind"
+
 #endif // RL_UTILS_PATHFIND_HPP
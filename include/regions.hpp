@@ -0,0 +1,29 @@
+#ifndef RL_UTILS_REGIONS_HPP
+#define RL_UTILS_REGIONS_HPP
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Splits the free cells of the map into connected regions, so that checking if
+// one cell can be reached from another is just a comparison of region ids.
+// This is useful for skipping pathfinding when there is no path at all (which
+// is the worst case for a floodfill, since the whole region is searched).
+//
+// Blocked cells get the id -1, and so do the outermost cells of the map (which
+// are never entered by floodfill or pathfind). The other cells get ids from
+// zero and up, and "sizes_out" gets the number of cells in each region.
+//------------------------------------------------------------------------------
+void label_regions(const bool blocked[map_w][map_h],
+                   Array2<int>& ids_out,
+                   std::vector<int>& sizes_out,
+                   const bool allow_diagonal = true);
+
+// Returns true if there is a path between the cells (as for "pathfind"), given
+// the region ids from "label_regions". The origin itself may be blocked (e.g.
+// by a monster standing there), then its free neighbours are checked instead.
+bool is_reachable(const Array2<int>& ids,
+                  const P& p0,
+                  const P& p1,
+                  const bool allow_diagonal = true);
+
+#endif // RL_UTILS_REGIONS_HPP
@@ -95,12 +95,27 @@ void assert_impl(const bool check,
 // RL Utils includes
 // NOTE: The user project only needs to include rl_utils.hpp (this file)
 #include "array2.hpp"
+#include "grid_view.hpp"
+#include "array2_view.hpp"
+#include "bit_grid.hpp"
 #include "direction.hpp"
+#include "dist_transform.hpp"
 #include "flood.hpp"
+#include "flood_field.hpp"
+#include "flow_field.hpp"
 #include "pathfind.hpp"
+#include "path_cache.hpp"
+#include "path_smooth.hpp"
+#include "compact_path.hpp"
+#include "coop_pathfind.hpp"
 #include "pos.hpp"
 #include "random.hpp"
 #include "rect.hpp"
+#include "regions.hpp"
+#include "search_ctx.hpp"
+#include "sliced_search.hpp"
+#include "hpa.hpp"
+#include "flood_pool.hpp"
 #include "misc.hpp"
 #include "time.hpp"
 
@@ -0,0 +1,94 @@
+#ifndef RL_UTILS_SEARCH_CTX_HPP
+#define RL_UTILS_SEARCH_CTX_HPP
+
+#include <vector>
+#include <cstdint>
+
+// Node in the open list of a best first search (e.g. A*), with the steps
+// traveled so far ("g") and the estimated total number of steps ("f")
+struct SearchNode
+{
+    SearchNode(const P& p, const int g, const int f) :
+        p   (p),
+        g   (g),
+        f   (f) {}
+
+    P p;
+    int g;
+    int f;
+};
+
+//------------------------------------------------------------------------------
+// Buffers for floodfill and pathfinding, which can be kept between searches to
+// avoid allocating memory or clearing a whole map array on every call. Each
+// value is stamped with the generation it was set in, so clearing the values
+// for a new search only requires incrementing the current generation.
+//------------------------------------------------------------------------------
+class SearchCtx
+{
+public:
+    SearchCtx();
+
+    SearchCtx(const SearchCtx&) = delete;
+
+    SearchCtx& operator=(const SearchCtx&) = delete;
+
+    // Sets all values to zero
+    void clear_vals();
+
+    int val(const P& p) const
+    {
+        return
+            (gen_stamps_[p.x][p.y] == gen_) ?
+            vals_[p.x][p.y] :
+            0;
+    }
+
+    void set_val(const P& p, const int v)
+    {
+        vals_[p.x][p.y] = v;
+
+        gen_stamps_[p.x][p.y] = gen_;
+    }
+
+    // The cell a search came from (e.g. the previous jump point) - this is
+    // only valid for cells which have a value in the current search
+    const P& parent(const P& p) const
+    {
+        return parents_[p.x][p.y];
+    }
+
+    void set_parent(const P& p, const P& parent)
+    {
+        parents_[p.x][p.y] = parent;
+    }
+
+    std::vector<P>& positions()
+    {
+        return positions_;
+    }
+
+    // Open list for best first searches, used as a heap (with std::push_heap
+    // and std::pop_heap) - the memory is kept between searches
+    std::vector<SearchNode>& open_nodes()
+    {
+        return open_nodes_;
+    }
+
+private:
+    uint32_t gen_;
+    uint32_t gen_stamps_[map_w][map_h];
+    int vals_[map_w][map_h];
+    P parents_[map_w][map_h];
+    std::vector<P> positions_;
+    std::vector<SearchNode> open_nodes_;
+};
+
+// A search context owned by the calling thread, which is used by the functions
+// that do not take a context as a parameter (so that they do not need to clear
+// or allocate a whole map array on each call).
+//
+// NOTE: Do not pass this to a function which also uses it internally.
+SearchCtx& thread_search_ctx();
+
+#endif // RL_UTILS_SEARCH_CTX_HPP
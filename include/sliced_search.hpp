@@ -0,0 +1,71 @@
+#ifndef RL_UTILS_SLICED_SEARCH_HPP
+#define RL_UTILS_SLICED_SEARCH_HPP
+
+#include <vector>
+
+enum class SearchState
+{
+    in_progress,
+    found,
+    no_path
+};
+
+//------------------------------------------------------------------------------
+// Resumable pathfinding, which can be spread out over several calls (e.g. over
+// several frames), to put an upper limit on the time spent per call. The
+// search is started with "start", and then advanced with "step" until it is
+// no longer in progress. The resulting path is the same as from "pathfind".
+//
+// NOTE: The blocked array passed to "start" is read on each "step" call, so it
+// must stay alive (and should not be changed) until the search is finished.
+//------------------------------------------------------------------------------
+class SlicedSearch
+{
+public:
+    SlicedSearch();
+
+    SlicedSearch(const SlicedSearch&) = delete;
+
+    SlicedSearch& operator=(const SlicedSearch&) = delete;
+
+    void start(const P& p0,
+               const P& p1,
+               const bool blocked[map_w][map_h],
+               const bool allow_diagonal = true,
+               const bool randomize_steps = false);
+
+    // Expands at most "node_budget" positions, and returns the new state
+    SearchState step(const int node_budget);
+
+    SearchState state() const
+    {
+        return state_;
+    }
+
+    // Total number of positions expanded since the search was started
+    int nr_nodes_expanded() const
+    {
+        return nr_nodes_expanded_;
+    }
+
+    // The path goes from target to origin, not including the origin (this is
+    // empty until the state is "found")
+    const std::vector<P>& path() const
+    {
+        return path_;
+    }
+
+private:
+    SearchCtx ctx_;
+    const bool (*blocked_)[map_h];
+    P p0_;
+    P p1_;
+    bool allow_diagonal_;
+    bool randomize_steps_;
+    SearchState state_;
+    size_t next_p_idx_;
+    int nr_nodes_expanded_;
+    std::vector<P> path_;
+};
+
+#endif // RL_UTILS_SLICED_SEARCH_HPP
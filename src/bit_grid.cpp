@@ -0,0 +1,264 @@
+#include "rl_utils.hpp"
+
+#include "bit_utils.hpp"
+
+BitGrid::BitGrid() :
+    BitGrid(P(map_w, map_h)) {}
+
+BitGrid::BitGrid(const P& dims) :
+    dims_           (dims),
+    nr_row_words_   ((dims.x + 63) / 64),
+    words_          (nr_row_words_ * dims.y, 0) {}
+
+BitGrid::BitGrid(const bool a[map_w][map_h]) :
+    BitGrid(P(map_w, map_h))
+{
+    for (int x = 0; x < map_w; ++x)
+    {
+        const uint64_t bit = uint64_t(1) << (x % 64);
+
+        const int word_idx = x / 64;
+
+        for (int y = 0; y < map_h; ++y)
+        {
+            if (a[x][y])
+            {
+                row(y)[word_idx] |= bit;
+            }
+        }
+    }
+}
+
+void BitGrid::to_array(bool out[map_w][map_h]) const
+{
+    ASSERT(dims_ == P(map_w, map_h));
+
+    for (int x = 0; x < map_w; ++x)
+    {
+        const int word_idx = x / 64;
+        const int bit_idx = x % 64;
+
+        for (int y = 0; y < map_h; ++y)
+        {
+            out[x][y] = (row(y)[word_idx] >> bit_idx) & 1;
+        }
+    }
+}
+
+void BitGrid::fill(const bool v)
+{
+    std::fill(begin(words_), end(words_), v ? ~uint64_t(0) : 0);
+
+    if (v)
+    {
+        clear_padding();
+    }
+}
+
+int BitGrid::count() const
+{
+    int n = 0;
+
+    for (const uint64_t word : words_)
+    {
+        n += bit_utils::popcount(word);
+    }
+
+    return n;
+}
+
+bool BitGrid::is_any() const
+{
+    for (const uint64_t word : words_)
+    {
+        if (word)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+P BitGrid::find_first() const
+{
+    if (words_.empty())
+    {
+        return P(-1, -1);
+    }
+
+    if (at(P(0, 0)))
+    {
+        return P(0, 0);
+    }
+
+    return find_next(P(0, 0));
+}
+
+P BitGrid::find_next(const P& p) const
+{
+    // Start at the cell after "p"
+    int x = p.x + 1;
+    int y = p.y;
+
+    if (x >= dims_.x)
+    {
+        x = 0;
+        ++y;
+    }
+
+    if (y >= dims_.y)
+    {
+        return P(-1, -1);
+    }
+
+    size_t word_idx = (y * nr_row_words_) + (x / 64);
+
+    // Ignore the bits before the starting cell in the first word
+    uint64_t word = words_[word_idx] & (~uint64_t(0) << (x % 64));
+
+    while (true)
+    {
+        if (word)
+        {
+            const int row_idx = word_idx / nr_row_words_;
+
+            const int row_word_idx = word_idx % nr_row_words_;
+
+            return P((row_word_idx * 64) + bit_utils::lowest_bit_idx(word), row_idx);
+        }
+
+        ++word_idx;
+
+        if (word_idx == words_.size())
+        {
+            return P(-1, -1);
+        }
+
+        word = words_[word_idx];
+    }
+}
+
+void BitGrid::shift(const Dir dir)
+{
+    const P d(dir_utils::offset(dir));
+
+    if (d.x == 1)
+    {
+        // Move right - each bit moves to a higher index
+        for (int y = 0; y < dims_.y; ++y)
+        {
+            uint64_t* const r = row(y);
+
+            for (int w = nr_row_words_ - 1; w >= 0; --w)
+            {
+                r[w] = (r[w] << 1) | ((w > 0) ? (r[w - 1] >> 63) : 0);
+            }
+        }
+
+        clear_padding();
+    }
+    else if (d.x == -1)
+    {
+        for (int y = 0; y < dims_.y; ++y)
+        {
+            uint64_t* const r = row(y);
+
+            for (int w = 0; w < nr_row_words_; ++w)
+            {
+                r[w] =
+                    (r[w] >> 1) |
+                    ((w < (nr_row_words_ - 1)) ? (r[w + 1] << 63) : 0);
+            }
+        }
+    }
+
+    if (d.y == 1)
+    {
+        // Move down - each row is replaced by the row above
+        for (int y = dims_.y - 1; y > 0; --y)
+        {
+            std::copy_n(row(y - 1), nr_row_words_, row(y));
+        }
+
+        if (dims_.y > 0)
+        {
+            std::fill_n(row(0), nr_row_words_, 0);
+        }
+    }
+    else if (d.y == -1)
+    {
+        for (int y = 0; y < (dims_.y - 1); ++y)
+        {
+            std::copy_n(row(y + 1), nr_row_words_, row(y));
+        }
+
+        if (dims_.y > 0)
+        {
+            std::fill_n(row(dims_.y - 1), nr_row_words_, 0);
+        }
+    }
+}
+
+void BitGrid::flip()
+{
+    for (uint64_t& word : words_)
+    {
+        word = ~word;
+    }
+
+    clear_padding();
+}
+
+BitGrid& BitGrid::operator&=(const BitGrid& other)
+{
+    ASSERT(dims_ == other.dims_);
+
+    for (size_t i = 0; i < words_.size(); ++i)
+    {
+        words_[i] &= other.words_[i];
+    }
+
+    return *this;
+}
+
+BitGrid& BitGrid::operator|=(const BitGrid& other)
+{
+    ASSERT(dims_ == other.dims_);
+
+    for (size_t i = 0; i < words_.size(); ++i)
+    {
+        words_[i] |= other.words_[i];
+    }
+
+    return *this;
+}
+
+BitGrid& BitGrid::operator^=(const BitGrid& other)
+{
+    ASSERT(dims_ == other.dims_);
+
+    for (size_t i = 0; i < words_.size(); ++i)
+    {
+        words_[i] ^= other.words_[i];
+    }
+
+    return *this;
+}
+
+void BitGrid::clear_padding()
+{
+    const int nr_used_bits = dims_.x % 64;
+
+    if ((nr_used_bits == 0) || (nr_row_words_ == 0))
+    {
+        return;
+    }
+
+    const uint64_t mask = (uint64_t(1) << nr_used_bits) - 1;
+
+    for (int y = 0; y < dims_.y; ++y)
+    {
+        row(y)[nr_row_words_ - 1] &= mask;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef RL_UTILS_BIT_UTILS_HPP
+#define RL_UTILS_BIT_UTILS_HPP
+
+#include <cstdint>
+
+// NOTE: This is an internal header for the RL Utils sources, it is not included
+// by rl_utils.hpp
+
+namespace bit_utils
+{
+
+// Index of the lowest set bit, "bits" must not be zero
+inline int lowest_bit_idx(const uint64_t bits)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(bits);
+#else
+    int idx = 0;
+
+    while (!(bits & (uint64_t(1) << idx)))
+    {
+        ++idx;
+    }
+
+    return idx;
+#endif // __GNUC__
+}
+
+// Number of set bits
+inline int popcount(uint64_t bits)
+{
+#ifdef __GNUC__
+    return __builtin_popcountll(bits);
+#else
+    int n = 0;
+
+    while (bits)
+    {
+        bits &= bits - 1;
+
+        ++n;
+    }
+
+    return n;
+#endif // __GNUC__
+}
+
+} // bit_utils
+
+#endif // RL_UTILS_BIT_UTILS_HPP
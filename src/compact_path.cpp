@@ -0,0 +1,257 @@
+#include "rl_utils.hpp"
+
+#include <cstring>
+
+namespace
+{
+
+// Index in "dir_utils::dir_list" for each offset, indexed by [x + 1][y + 1]
+const int offset_codes[3][3] =
+{
+    {4, 0, 5},
+    {2, -1, 3},
+    {6, 1, 7}
+};
+
+size_t nr_words_for_steps(const size_t nr_steps)
+{
+    return
+        (nr_steps + CompactPath::steps_per_word - 1) /
+        CompactPath::steps_per_word;
+}
+
+} // namespace
+
+const size_t CompactPath::steps_per_word;
+const size_t CompactPath::nr_inline_words;
+const size_t CompactPath::nr_inline_steps;
+
+CompactPath::CompactPath() :
+    origin_     (0, 0),
+    target_     (0, 0),
+    first_idx_  (0),
+    end_idx_    (0),
+    capacity_   (nr_inline_steps)
+{
+    std::fill_n(inline_words_, nr_inline_words, 0);
+}
+
+CompactPath::CompactPath(const P& p0, const std::vector<P>& path) :
+    CompactPath()
+{
+    clear(p0);
+
+    P prev_p(p0);
+
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        push_back(dir_utils::dir(*it - prev_p));
+
+        prev_p = *it;
+    }
+}
+
+CompactPath::CompactPath(const CompactPath& other) :
+    CompactPath()
+{
+    copy_from(other);
+}
+
+CompactPath::CompactPath(CompactPath&& other) noexcept :
+    CompactPath()
+{
+    steal_from(other);
+}
+
+CompactPath::~CompactPath()
+{
+    free_heap();
+}
+
+CompactPath& CompactPath::operator=(const CompactPath& other)
+{
+    if (&other != this)
+    {
+        copy_from(other);
+    }
+
+    return *this;
+}
+
+CompactPath& CompactPath::operator=(CompactPath&& other) noexcept
+{
+    if (&other != this)
+    {
+        free_heap();
+
+        steal_from(other);
+    }
+
+    return *this;
+}
+
+void CompactPath::clear(const P& p0)
+{
+    origin_ = p0;
+    target_ = p0;
+
+    first_idx_ = 0;
+    end_idx_ = 0;
+
+    // NOTE: Any heap memory is kept for reuse
+    std::fill_n(words(), nr_words_for_steps(capacity_), 0);
+}
+
+void CompactPath::push_back(const Dir dir)
+{
+    const P& d = dir_utils::offset(dir);
+
+    const int code = offset_codes[d.x + 1][d.y + 1];
+
+    ASSERT(code >= 0);
+
+    if (end_idx_ == capacity_)
+    {
+        // Move the steps to the start of the buffer, and grow it if needed
+        const size_t nr_steps = size();
+
+        const size_t new_capacity =
+            (first_idx_ > (capacity_ / 2)) ?
+            capacity_ :
+            (capacity_ * 2);
+
+        const bool is_new_on_heap = new_capacity > nr_inline_steps;
+
+        uint64_t inline_buffer[nr_inline_words];
+
+        uint64_t* const new_words =
+            is_new_on_heap ?
+            new uint64_t[nr_words_for_steps(new_capacity)] :
+            inline_buffer;
+
+        std::fill_n(new_words, nr_words_for_steps(new_capacity), 0);
+
+        for (size_t i = 0; i < nr_steps; ++i)
+        {
+            new_words[i / steps_per_word] |=
+                (uint64_t)code_at(first_idx_ + i) <<
+                ((i % steps_per_word) * 3);
+        }
+
+        free_heap();
+
+        capacity_ = new_capacity;
+
+        if (is_new_on_heap)
+        {
+            heap_words_ = new_words;
+        }
+        else
+        {
+            std::memcpy(inline_words_, inline_buffer, sizeof(inline_words_));
+        }
+
+        first_idx_ = 0;
+        end_idx_ = nr_steps;
+    }
+
+    words()[end_idx_ / steps_per_word] |=
+        (uint64_t)code << ((end_idx_ % steps_per_word) * 3);
+
+    ++end_idx_;
+
+    target_ += d;
+}
+
+void CompactPath::pop_front()
+{
+    ASSERT(!empty());
+
+    origin_ += offset_at(first_idx_);
+
+    // Clear the code, so that the bits can be reused when pushing new steps
+    words()[first_idx_ / steps_per_word] &=
+        ~((uint64_t)7 << ((first_idx_ % steps_per_word) * 3));
+
+    ++first_idx_;
+
+    if (empty())
+    {
+        first_idx_ = 0;
+        end_idx_ = 0;
+    }
+}
+
+Dir CompactPath::front_dir() const
+{
+    ASSERT(!empty());
+
+    return dir_utils::dir(offset_at(first_idx_));
+}
+
+void CompactPath::to_vec(std::vector<P>& out) const
+{
+    out.resize(size());
+
+    P p(origin_);
+
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        p += offset_at(first_idx_ + i);
+
+        out[out.size() - 1 - i] = p;
+    }
+}
+
+void CompactPath::copy_from(const CompactPath& other)
+{
+    free_heap();
+
+    origin_ = other.origin_;
+    target_ = other.target_;
+    first_idx_ = other.first_idx_;
+    end_idx_ = other.end_idx_;
+    capacity_ = other.capacity_;
+
+    const size_t nr_words = nr_words_for_steps(capacity_);
+
+    if (is_on_heap())
+    {
+        heap_words_ = new uint64_t[nr_words];
+    }
+
+    std::copy_n(other.words(), nr_words, words());
+}
+
+void CompactPath::steal_from(CompactPath& other)
+{
+    origin_ = other.origin_;
+    target_ = other.target_;
+    first_idx_ = other.first_idx_;
+    end_idx_ = other.end_idx_;
+    capacity_ = other.capacity_;
+
+    if (is_on_heap())
+    {
+        heap_words_ = other.heap_words_;
+    }
+    else
+    {
+        std::copy_n(other.inline_words_, nr_inline_words, inline_words_);
+    }
+
+    // The other path is left empty, using the inline storage
+    other.capacity_ = nr_inline_steps;
+
+    other.clear(other.origin_);
+}
+
+void CompactPath::free_heap()
+{
+    if (is_on_heap())
+    {
+        delete[] heap_words_;
+
+        capacity_ = nr_inline_steps;
+    }
+}
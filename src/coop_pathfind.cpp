@@ -0,0 +1,452 @@
+#include "rl_utils.hpp"
+
+#include <queue>
+
+#include "flood_bfs.hpp"
+
+namespace
+{
+
+struct CoopNode
+{
+    CoopNode(const int idx, const int g, const int f) :
+        idx (idx),
+        g   (g),
+        f   (f) {}
+
+    // Index of the position and time
+    int idx;
+    int g;
+    int f;
+};
+
+struct CoopNodeCmp
+{
+    bool operator()(const CoopNode& n0, const CoopNode& n1) const
+    {
+        // Lowest estimated total cost first - on ties, prefer the node which
+        // has traveled furthest
+        if (n0.f != n1.f)
+        {
+            return n0.f > n1.f;
+        }
+
+        return n0.g < n1.g;
+    }
+};
+
+int node_idx(const P& p, const int t)
+{
+    return (t * nr_map_cells) + (p.x * map_h) + p.y;
+}
+
+P node_pos(const int idx)
+{
+    const int cell_idx = idx % nr_map_cells;
+
+    return P(cell_idx / map_h, cell_idx % map_h);
+}
+
+int node_time(const int idx)
+{
+    return idx / nr_map_cells;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// Reservation table
+//------------------------------------------------------------------------------
+ReservationTable::ReservationTable(const int nr_turns) :
+    nr_turns_   (nr_turns),
+    gen_        (1),
+    gen_stamps_ ((nr_turns + 1) * nr_map_cells, 0),
+    owners_     ((nr_turns + 1) * nr_map_cells, -1) {}
+
+void ReservationTable::clear()
+{
+    ++gen_;
+
+    if (gen_ == 0)
+    {
+        // The generation counter wrapped around, old stamps could now be
+        // mistaken for current ones
+        std::fill(begin(gen_stamps_), end(gen_stamps_), 0);
+
+        gen_ = 1;
+    }
+}
+
+void ReservationTable::reserve(const P& p, const int t, const int agent_id)
+{
+    ASSERT(t >= 0 && t <= nr_turns_);
+
+    const size_t idx = (t * nr_map_cells) + (p.x * map_h) + p.y;
+
+    gen_stamps_[idx] = gen_;
+
+    owners_[idx] = agent_id;
+}
+
+void ReservationTable::release(const P& p, const int t)
+{
+    ASSERT(t >= 0 && t <= nr_turns_);
+
+    const size_t idx = (t * nr_map_cells) + (p.x * map_h) + p.y;
+
+    gen_stamps_[idx] = 0;
+}
+
+//------------------------------------------------------------------------------
+// Cooperative pathfinder
+//------------------------------------------------------------------------------
+size_t CoopPathfinder::KeyHash::operator()(const Key& key) const
+{
+    size_t h = key.revision;
+
+    h = (h * 31) + key.p.x;
+    h = (h * 31) + key.p.y;
+    h = (h * 31) + (key.allow_diagonal ? 1 : 0);
+
+    return h;
+}
+
+CoopPathfinder::CoopPathfinder(const int window,
+                               const size_t max_nr_target_floods) :
+    window_             (window),
+    revision_           (0),
+    reservations_       (window),
+    target_floods_      (max_nr_target_floods),
+    search_gen_         (1),
+    search_gen_stamps_  ((window + 1) * nr_map_cells, 0),
+    search_g_           ((window + 1) * nr_map_cells, 0),
+    search_parents_     ((window + 1) * nr_map_cells, -1)
+{
+    ASSERT(window > 0);
+}
+
+const std::vector<int>& CoopPathfinder::target_flood(
+    const P& p1,
+    const bool blocked[map_w][map_h],
+    const bool allow_diagonal)
+{
+    const Key key(p1, allow_diagonal, revision_);
+
+    const std::vector<int>* const cached = target_floods_.find(key);
+
+    if (cached)
+    {
+        return *cached;
+    }
+
+    std::vector<int> flood(nr_map_cells);
+
+    floodfill(p1,
+              blocked,
+              reinterpret_cast<int(*)[map_h]>(flood.data()),
+              -1,
+              P(-1, -1),
+              allow_diagonal);
+
+    return target_floods_.insert(key, std::move(flood));
+}
+
+void CoopPathfinder::pathfind(const std::vector<PathReq>& reqs,
+                              const bool blocked[map_w][map_h],
+                              std::vector< std::vector<P> >& out,
+                              const bool allow_diagonal)
+{
+    const size_t nr_reqs = reqs.size();
+
+    out.resize(nr_reqs);
+
+    // Flood from each target first - agents which cannot reach their target
+    // stand still for the whole window (they are reserved before planning the
+    // others)
+    std::vector<bool> is_standing_still(nr_reqs, false);
+
+    for (size_t i = 0; i < nr_reqs; ++i)
+    {
+        const PathReq& req = reqs[i];
+
+        const std::vector<int>& flood =
+            target_flood(req.p1, blocked, allow_diagonal);
+
+        const bool is_reachable =
+            (req.p0 == req.p1) ||
+            (flood[(req.p0.x * map_h) + req.p0.y] != 0);
+
+        is_standing_still[i] = !is_reachable;
+    }
+
+    bool is_done = false;
+
+    while (!is_done)
+    {
+        is_done = true;
+
+        reservations_.clear();
+
+        // The current positions are reserved, so that no agent tries to swap
+        // places with another agent on the first turn. The agents also keep
+        // their cell for the next turn until they are planned.
+        for (size_t i = 0; i < nr_reqs; ++i)
+        {
+            const P& p0 = reqs[i].p0;
+
+            out[i].clear();
+
+            const int nr_turns_reserved =
+                is_standing_still[i] ?
+                window_ :
+                1;
+
+            for (int t = 0; t <= nr_turns_reserved; ++t)
+            {
+                reservations_.reserve(p0, t, (int)i);
+            }
+        }
+
+        for (size_t i = 0; i < nr_reqs; ++i)
+        {
+            if (is_standing_still[i])
+            {
+                continue;
+            }
+
+            const PathReq& req = reqs[i];
+
+            // NOTE: The flood is looked up again, since it may have been
+            // evicted if there are more targets than cache entries
+            const std::vector<int>& flood =
+                target_flood(req.p1, blocked, allow_diagonal);
+
+            const bool is_found =
+                pathfind_agent(
+                    (int)i,
+                    req,
+                    flood,
+                    blocked,
+                    out[i],
+                    allow_diagonal);
+
+            if (is_found)
+            {
+                continue;
+            }
+
+            // Boxed in - stand still. If an earlier agent has planned to step
+            // into the cell, start over with this agent standing still for
+            // the whole window (this happens at most once per agent).
+            bool is_cell_taken = false;
+
+            for (int t = 2; t <= window_; ++t)
+            {
+                const int owner = reservations_.owner(req.p0, t);
+
+                if ((owner != -1) && (owner != (int)i))
+                {
+                    is_cell_taken = true;
+
+                    break;
+                }
+            }
+
+            if (is_cell_taken)
+            {
+                is_standing_still[i] = true;
+
+                is_done = false;
+
+                break;
+            }
+
+            for (int t = 2; t <= window_; ++t)
+            {
+                reservations_.reserve(req.p0, t, (int)i);
+            }
+        }
+    }
+}
+
+bool CoopPathfinder::pathfind_agent(const int agent_id,
+                                    const PathReq& req,
+                                    const std::vector<int>& flood,
+                                    const bool blocked[map_w][map_h],
+                                    std::vector<P>& out,
+                                    const bool allow_diagonal)
+{
+    out.clear();
+
+    ++search_gen_;
+
+    if (search_gen_ == 0)
+    {
+        std::fill(begin(search_gen_stamps_), end(search_gen_stamps_), 0);
+
+        search_gen_ = 1;
+    }
+
+    const P& p0 = req.p0;
+    const P& p1 = req.p1;
+
+    // Walking distance to the target, or -1 if the target cannot be reached
+    auto dist = [&](const P& p)
+    {
+        if (p == p1)
+        {
+            return 0;
+        }
+
+        const int v = flood[(p.x * map_h) + p.y];
+
+        return (v == 0) ? -1 : v;
+    };
+
+    const std::vector<P>& dirs = allow_diagonal ?
+                                 dir_utils::dir_list_w_center :
+                                 dir_utils::cardinal_list_w_center;
+
+    std::priority_queue<CoopNode,
+                        std::vector<CoopNode>,
+                        CoopNodeCmp> open;
+
+    const int start_idx = node_idx(p0, 0);
+
+    search_gen_stamps_[start_idx] = search_gen_;
+    search_g_[start_idx] = 0;
+    search_parents_[start_idx] = -1;
+
+    open.push(CoopNode(start_idx, 0, dist(p0)));
+
+    int end_idx = -1;
+
+    while (!open.empty())
+    {
+        const CoopNode node = open.top();
+
+        open.pop();
+
+        if (node.g > search_g_[node.idx])
+        {
+            // Outdated entry
+            continue;
+        }
+
+        const int t = node_time(node.idx);
+
+        if (t == window_)
+        {
+            end_idx = node.idx;
+
+            break;
+        }
+
+        const P p(node_pos(node.idx));
+
+        for (const P& d : dirs)
+        {
+            const P new_p(p + d);
+
+            const bool is_wait = (d.x == 0) && (d.y == 0);
+
+            if (!is_wait &&
+                (!flood_bfs::map_flood_bounds.is_p_inside(new_p) ||
+                 blocked[new_p.x][new_p.y]))
+            {
+                continue;
+            }
+
+            const int h = dist(new_p);
+
+            if (h < 0)
+            {
+                continue;
+            }
+
+            // Is the cell free at the next turn?
+            const int owner = reservations_.owner(new_p, t + 1);
+
+            if ((owner != -1) && (owner != agent_id))
+            {
+                continue;
+            }
+
+            // Would this swap places with another agent?
+            if (!is_wait)
+            {
+                const int other = reservations_.owner(new_p, t);
+
+                if ((other != -1) &&
+                    (other != agent_id) &&
+                    (reservations_.owner(p, t + 1) == other))
+                {
+                    continue;
+                }
+            }
+
+            // Waiting at the target is free, everything else costs one turn
+            const int cost = (is_wait && (p == p1)) ? 0 : 1;
+
+            const int new_g = node.g + cost;
+
+            const int new_idx = node_idx(new_p, t + 1);
+
+            if ((search_gen_stamps_[new_idx] == search_gen_) &&
+                (search_g_[new_idx] <= new_g))
+            {
+                continue;
+            }
+
+            search_gen_stamps_[new_idx] = search_gen_;
+            search_g_[new_idx] = new_g;
+            search_parents_[new_idx] = node.idx;
+
+            open.push(CoopNode(new_idx, new_g, new_g + h));
+        }
+    }
+
+    if (end_idx == -1)
+    {
+        return false;
+    }
+
+    // The agent gives up its cell on the next turn (it is reserved again
+    // below if the agent waits there)
+    reservations_.release(p0, 1);
+
+    // Reserve the positions, and store the path (the first element is the
+    // position at the end of the window)
+    for (int idx = end_idx; idx != start_idx; idx = search_parents_[idx])
+    {
+        const P p(node_pos(idx));
+
+        reservations_.reserve(p, node_time(idx), agent_id);
+
+        out.push_back(p);
+    }
+
+    // Remove the turns spent waiting at the target at the end of the path
+    size_t nr_waits = 0;
+
+    while (nr_waits < out.size())
+    {
+        const P& prev_p =
+            ((nr_waits + 1) < out.size()) ?
+            out[nr_waits + 1] :
+            p0;
+
+        if ((out[nr_waits] == p1) && (prev_p == p1))
+        {
+            ++nr_waits;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    out.erase(begin(out), begin(out) + nr_waits);
+
+    return true;
+}
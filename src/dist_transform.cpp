@@ -0,0 +1,254 @@
+#include "rl_utils.hpp"
+
+#include <climits>
+
+namespace
+{
+
+const int chamfer_inf = INT_MAX / 2;
+
+const double euclidean_inf = 1e20;
+
+// Two pass chamfer transform (exact for king and taxicab distances) - first
+// from the top left, then from the bottom right
+void chamfer_transform(const GridView<const bool>& features,
+                       const GridView<int>& out,
+                       const bool allow_diagonal)
+{
+    const P& d = features.dims();
+
+    for (int x = 0; x < d.x; ++x)
+    {
+        for (int y = 0; y < d.y; ++y)
+        {
+            int v = features(x, y) ? 0 : chamfer_inf;
+
+            if (v != 0)
+            {
+                if (x > 0)
+                {
+                    v = std::min(v, out(x - 1, y) + 1);
+
+                    if (allow_diagonal)
+                    {
+                        if (y > 0)
+                        {
+                            v = std::min(v, out(x - 1, y - 1) + 1);
+                        }
+
+                        if (y < (d.y - 1))
+                        {
+                            v = std::min(v, out(x - 1, y + 1) + 1);
+                        }
+                    }
+                }
+
+                if (y > 0)
+                {
+                    v = std::min(v, out(x, y - 1) + 1);
+                }
+            }
+
+            out(x, y) = v;
+        }
+    }
+
+    for (int x = d.x - 1; x >= 0; --x)
+    {
+        for (int y = d.y - 1; y >= 0; --y)
+        {
+            int v = out(x, y);
+
+            if (v != 0)
+            {
+                if (x < (d.x - 1))
+                {
+                    v = std::min(v, out(x + 1, y) + 1);
+
+                    if (allow_diagonal)
+                    {
+                        if (y > 0)
+                        {
+                            v = std::min(v, out(x + 1, y - 1) + 1);
+                        }
+
+                        if (y < (d.y - 1))
+                        {
+                            v = std::min(v, out(x + 1, y + 1) + 1);
+                        }
+                    }
+                }
+
+                if (y < (d.y - 1))
+                {
+                    v = std::min(v, out(x, y + 1) + 1);
+                }
+            }
+
+            out(x, y) = v;
+        }
+    }
+
+    // If there are no feature cells at all, all cells are still "infinite"
+    if (out(0, 0) >= chamfer_inf)
+    {
+        out.fill(-1);
+    }
+}
+
+// One dimensional squared euclidean transform of "f" (Felzenszwalb &
+// Huttenlocher), by finding the lower envelope of the parabolas rooted at each
+// position. The buffers must have room for n (and n + 1 for "z") elements.
+void euclidean_transform_1d(const double* const f,
+                            double* const out,
+                            const int n,
+                            int* const v,
+                            double* const z)
+{
+    // Index of the rightmost parabola in the lower envelope
+    int k = 0;
+
+    v[0] = 0;
+    z[0] = -euclidean_inf;
+    z[1] = euclidean_inf;
+
+    for (int q = 1; q < n; ++q)
+    {
+        double s = 0.0;
+
+        while (true)
+        {
+            const int vk = v[k];
+
+            s =
+                ((f[q] + (q * q)) - (f[vk] + (vk * vk))) /
+                (2.0 * (q - vk));
+
+            if ((s <= z[k]) && (k > 0))
+            {
+                --k;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        if (s <= z[k])
+        {
+            // The new parabola is below the whole envelope (only possible if
+            // the first parabola is at infinity)
+            v[0] = q;
+            z[0] = -euclidean_inf;
+            z[1] = euclidean_inf;
+
+            continue;
+        }
+
+        ++k;
+
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = euclidean_inf;
+    }
+
+    k = 0;
+
+    for (int q = 0; q < n; ++q)
+    {
+        while (z[k + 1] < q)
+        {
+            ++k;
+        }
+
+        const int vk = v[k];
+
+        out[q] = ((q - vk) * (q - vk)) + f[vk];
+    }
+}
+
+void euclidean_sq_transform(const GridView<const bool>& features,
+                            const GridView<int>& out)
+{
+    const P& d = features.dims();
+
+    const int max_len = std::max(d.x, d.y);
+
+    std::vector<double> f(max_len);
+    std::vector<double> result(max_len);
+    std::vector<int> v(max_len);
+    std::vector<double> z(max_len + 1);
+
+    // Distances within each column
+    std::vector<double> col_dists(d.x * d.y);
+
+    for (int x = 0; x < d.x; ++x)
+    {
+        for (int y = 0; y < d.y; ++y)
+        {
+            f[y] = features(x, y) ? 0.0 : euclidean_inf;
+        }
+
+        euclidean_transform_1d(
+            f.data(),
+            &col_dists[x * d.y],
+            d.y,
+            v.data(),
+            z.data());
+    }
+
+    // Combine the column distances along each row
+    for (int y = 0; y < d.y; ++y)
+    {
+        for (int x = 0; x < d.x; ++x)
+        {
+            f[x] = col_dists[(x * d.y) + y];
+        }
+
+        euclidean_transform_1d(
+            f.data(),
+            result.data(),
+            d.x,
+            v.data(),
+            z.data());
+
+        for (int x = 0; x < d.x; ++x)
+        {
+            out(x, y) =
+                (result[x] >= (euclidean_inf / 2.0)) ?
+                -1 :
+                (int)(result[x] + 0.5);
+        }
+    }
+}
+
+} // namespace
+
+void dist_transform(const GridView<const bool>& features,
+                    const GridView<int>& out,
+                    const DistMetric metric)
+{
+    ASSERT(features.dims() == out.dims());
+
+    const P& d = features.dims();
+
+    if ((d.x == 0) || (d.y == 0))
+    {
+        return;
+    }
+
+    switch (metric)
+    {
+    case DistMetric::king:
+        chamfer_transform(features, out, true);
+        break;
+
+    case DistMetric::taxi:
+        chamfer_transform(features, out, false);
+        break;
+
+    case DistMetric::euclidean_sq:
+        euclidean_sq_transform(features, out);
+        break;
+    }
+}
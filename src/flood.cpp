@@ -1,5 +1,99 @@
 #include "rl_utils.hpp"
 
+#include "bit_utils.hpp"
+#include "flood_bfs.hpp"
+
+namespace
+{
+
+// Number of 64 bit words needed to store one bit per cell on a map row
+const int nr_row_words = (map_w + 63) / 64;
+
+typedef uint64_t BitRows[map_h][nr_row_words];
+
+// Bits for each cell in "row", and each cell to the left and right of them
+void spread_row(const uint64_t* const row, uint64_t* const out)
+{
+    for (int w = 0; w < nr_row_words; ++w)
+    {
+        const uint64_t bits = row[w];
+
+        const uint64_t from_left =
+            (bits << 1) |
+            ((w > 0) ? (row[w - 1] >> 63) : 0);
+
+        const uint64_t from_right =
+            (bits >> 1) |
+            ((w < (nr_row_words - 1)) ? (row[w + 1] << 63) : 0);
+
+        out[w] = bits | from_left | from_right;
+    }
+}
+
+// Flood value storage for plain arrays and grid views
+class ViewVals
+{
+public:
+    ViewVals(const GridView<int>& vals) :
+        vals_(vals) {}
+
+    int val(const P& p) const
+    {
+        return vals_(p);
+    }
+
+    void set_val(const P& p, const int v)
+    {
+        vals_(p) = v;
+    }
+
+private:
+    const GridView<int> vals_;
+};
+
+// "Vals" is the storage of the flood values, where all values are expected to
+// be zero initially - this is either a grid view, or a search context. Only
+// positions inside "bounds" are flooded.
+template<typename Vals>
+void floodfill_impl(const P& p0,
+                    const GridView<const bool>& blocked,
+                    Vals& out,
+                    int travel_lmt,
+                    const P& p1,
+                    const bool allow_diagonal,
+                    std::vector<P>& positions,
+                    const R& bounds)
+{
+    // List of positions to travel to
+    positions.clear();
+
+    positions.push_back(p0);
+
+    // Instead of removing evaluated positions from the vector, we track which
+    // index to try next (cheaper than erasing front elements).
+    size_t next_p_idx = 0;
+
+    bool done = false;
+
+    while (!done)
+    {
+        const flood_bfs::StepResult result =
+            flood_bfs::expand_next(p0,
+                                   blocked,
+                                   out,
+                                   travel_lmt,
+                                   p1,
+                                   allow_diagonal,
+                                   positions,
+                                   next_p_idx,
+                                   bounds);
+
+        done = result != flood_bfs::StepResult::expanded;
+    }
+}
+
+} // namespace
+
 void floodfill(const P& p0,
                const bool blocked[map_w][map_h],
                int out[map_w][map_h],
@@ -9,101 +103,505 @@ void floodfill(const P& p0,
 {
     std::fill_n(*out, nr_map_cells, 0);
 
-    // List of positions to travel to
+    ViewVals vals(out);
+
     std::vector<P> positions;
 
     // In the worst case we need to visit every position, reserve elements
     positions.reserve(nr_map_cells);
 
-    // Instead of removing evaluated positions from the vector, we track which
-    // index to try next (cheaper than erasing front elements).
-    size_t next_p_idx = 0;
+    floodfill_impl(p0,
+                   blocked,
+                   vals,
+                   travel_lmt,
+                   p1,
+                   allow_diagonal,
+                   positions,
+                   flood_bfs::map_flood_bounds);
+}
+
+void floodfill(const P& p0,
+               const GridView<const bool>& blocked,
+               const GridView<int>& out,
+               int travel_lmt,
+               const P& p1,
+               const bool allow_diagonal)
+{
+    ASSERT(blocked.dims() == out.dims());
+
+    out.fill(0);
+
+    ViewVals vals(out);
+
+    std::vector<P> positions;
+
+    positions.reserve(out.dims().x * out.dims().y);
+
+    floodfill_impl(p0,
+                   blocked,
+                   vals,
+                   travel_lmt,
+                   p1,
+                   allow_diagonal,
+                   positions,
+                   R(P(0, 0), out.dims() - 1));
+}
+
+void floodfill(SearchCtx& ctx,
+               const P& p0,
+               const bool blocked[map_w][map_h],
+               int out[map_w][map_h],
+               int travel_lmt,
+               const P& p1,
+               const bool allow_diagonal)
+{
+    std::fill_n(*out, nr_map_cells, 0);
+
+    ViewVals vals(out);
+
+    floodfill_impl(p0,
+                   blocked,
+                   vals,
+                   travel_lmt,
+                   p1,
+                   allow_diagonal,
+                   ctx.positions(),
+                   flood_bfs::map_flood_bounds);
+}
+
+void floodfill(SearchCtx& ctx,
+               const P& p0,
+               const bool blocked[map_w][map_h],
+               int travel_lmt,
+               const P& p1,
+               const bool allow_diagonal)
+{
+    ctx.clear_vals();
+
+    floodfill_impl(p0,
+                   blocked,
+                   ctx,
+                   travel_lmt,
+                   p1,
+                   allow_diagonal,
+                   ctx.positions(),
+                   flood_bfs::map_flood_bounds);
+}
+
+void LocalFlood::reset(const R& r)
+{
+    r_.p0 = r.p0;
+    r_.p1 = r.p1;
+
+    // NOTE: This does not free any memory if the size decreases, so that
+    // the buffer can be reused for the next flood
+    vals_.assign(r_.w() * r_.h(), 0);
+}
+
+void floodfill_local(const P& p0,
+                     const bool blocked[map_w][map_h],
+                     LocalFlood& out,
+                     int travel_lmt,
+                     const P& p1,
+                     const bool allow_diagonal)
+{
+    ASSERT(travel_lmt >= 0);
+
+    // No cell further away than the travel limit can be reached (in either
+    // king or taxicab distance), so only this window needs to be stored
+    const R local_r(
+        P(std::max(p0.x - travel_lmt, 0),
+          std::max(p0.y - travel_lmt, 0)),
+        P(std::min(p0.x + travel_lmt, map_w - 1),
+          std::min(p0.y + travel_lmt, map_h - 1)));
+
+    out.reset(local_r);
+
+    const R flood_r(
+        P(std::max(local_r.p0.x, flood_bfs::map_flood_bounds.p0.x),
+          std::max(local_r.p0.y, flood_bfs::map_flood_bounds.p0.y)),
+        P(std::min(local_r.p1.x, flood_bfs::map_flood_bounds.p1.x),
+          std::min(local_r.p1.y, flood_bfs::map_flood_bounds.p1.y)));
+
+    floodfill_impl(p0,
+                   blocked,
+                   out,
+                   travel_lmt,
+                   p1,
+                   allow_diagonal,
+                   out.positions(),
+                   flood_r);
+}
+
+void floodfill_bitwise(const P& p0,
+                       const bool blocked[map_w][map_h],
+                       int out[map_w][map_h],
+                       int travel_lmt,
+                       const P& p1,
+                       const bool allow_diagonal)
+{
+    std::fill_n(*out, nr_map_cells, 0);
+
+    BitRows free_cells;
+    BitRows visited;
+    BitRows frontier;
+    BitRows next;
+
+    std::fill_n(*free_cells, map_h * nr_row_words, 0);
+    std::fill_n(*visited, map_h * nr_row_words, 0);
+    std::fill_n(*frontier, map_h * nr_row_words, 0);
+
+    // Only the free cells inside the flood bounds can be flooded
+    const R& bounds = flood_bfs::map_flood_bounds;
+
+    for (int x = bounds.p0.x; x <= bounds.p1.x; ++x)
+    {
+        for (int y = bounds.p0.y; y <= bounds.p1.y; ++y)
+        {
+            if (!blocked[x][y])
+            {
+                free_cells[y][x / 64] |= uint64_t(1) << (x % 64);
+            }
+        }
+    }
+
+    const uint64_t p0_bit = uint64_t(1) << (p0.x % 64);
+
+    visited[p0.y][p0.x / 64] = p0_bit;
+    frontier[p0.y][p0.x / 64] = p0_bit;
+
+    const bool is_stopping_at_tgt = p1.x != -1;
+
+    uint64_t spread[3][nr_row_words];
+
+    for (int val = 1; (travel_lmt == -1) || (val <= travel_lmt); ++val)
+    {
+        bool is_any_new = false;
+
+        std::fill_n(*next, map_h * nr_row_words, 0);
+
+        for (int y = 1; y < (map_h - 1); ++y)
+        {
+            if (allow_diagonal)
+            {
+                for (int w = 0; w < nr_row_words; ++w)
+                {
+                    spread[0][w] =
+                        frontier[y - 1][w] |
+                        frontier[y][w] |
+                        frontier[y + 1][w];
+                }
+
+                spread_row(spread[0], spread[1]);
+            }
+            else // Cardinals only
+            {
+                spread_row(frontier[y], spread[1]);
+
+                for (int w = 0; w < nr_row_words; ++w)
+                {
+                    spread[1][w] |=
+                        frontier[y - 1][w] |
+                        frontier[y + 1][w];
+                }
+            }
+
+            for (int w = 0; w < nr_row_words; ++w)
+            {
+                const uint64_t new_bits =
+                    spread[1][w] &
+                    free_cells[y][w] &
+                    ~visited[y][w];
 
-    int val = 0;
-    bool path_exists = true;
-    bool is_at_tgt = false;
-    bool is_stopping_at_tgt = p1.x != -1;
+                next[y][w] = new_bits;
 
-    const R bounds(P(1, 1), P(map_w, map_h) - 2);
+                is_any_new = is_any_new || (new_bits != 0);
+            }
+        }
 
-    P p(p0);
+        if (!is_any_new)
+        {
+            break;
+        }
+
+        bool is_at_tgt = false;
+
+        for (int y = 1; y < (map_h - 1); ++y)
+        {
+            for (int w = 0; w < nr_row_words; ++w)
+            {
+                uint64_t bits = next[y][w];
+
+                visited[y][w] |= bits;
+
+                while (bits)
+                {
+                    const int x = (w * 64) + bit_utils::lowest_bit_idx(bits);
+
+                    bits &= bits - 1;
+
+                    out[x][y] = val;
+
+                    if (is_stopping_at_tgt && (P(x, y) == p1))
+                    {
+                        is_at_tgt = true;
+                    }
+                }
+            }
+        }
+
+        if (is_at_tgt)
+        {
+            break;
+        }
+
+        std::copy_n(*next, map_h * nr_row_words, *frontier);
+    }
+}
+
+void floodfill_weighted(const P& p0,
+                        const int cost[map_w][map_h],
+                        int out[map_w][map_h],
+                        int travel_lmt,
+                        const P& p1,
+                        const bool allow_diagonal)
+{
+    std::fill_n(*out, nr_map_cells, 0);
+
+    const bool is_stopping_at_tgt = p1.x != -1;
+
+    const R& bounds = flood_bfs::map_flood_bounds;
 
     const auto& dirs =
         allow_diagonal ?
         dir_utils::dir_list :
         dir_utils::cardinal_list;
 
-    bool done = false;
+    const int max_cost = *std::max_element(*cost, *cost + nr_map_cells);
 
-    while (!done)
+    if (max_cost < 1)
     {
-        // "Flood" around the current position, and add those to the list of
-        // positions to travel to.
-        for (const P& d : dirs)
+        // Everything is blocked
+        return;
+    }
+
+    // Positions are stored in a circular list of buckets, indexed by their
+    // cost from the origin. Since no single step costs more than the maximum
+    // cell cost, there are never more than that many buckets in use.
+    std::vector< std::vector<P> > buckets(max_cost + 1);
+
+    buckets[0].push_back(p0);
+
+    // Number of positions stored in the buckets
+    size_t nr_queued = 1;
+
+    for (int val = 0; nr_queued > 0; ++val)
+    {
+        if ((travel_lmt != -1) && (val > travel_lmt))
         {
-            const P new_p(p + d);
+            break;
+        }
+
+        std::vector<P>& bucket = buckets[val % buckets.size()];
+
+        // NOTE: New positions are never added to the current bucket (there are
+        // no zero cost steps), so it's safe to iterate over it here
+        for (const P& p : bucket)
+        {
+            --nr_queued;
+
+            if ((p != p0) && (out[p.x][p.y] != val))
+            {
+                // A cheaper way to this cell was found after it was added
+                continue;
+            }
+
+            if (is_stopping_at_tgt && (p == p1))
+            {
+                return;
+            }
 
-            if (!blocked[new_p.x][new_p.y] &&
-                bounds.is_p_inside(new_p) &&
-                (out[new_p.x][new_p.y] == 0) &&
-                (new_p != p0))
+            for (const P& d : dirs)
             {
-                val = out[p.x][p.y];
+                const P new_p(p + d);
 
-                if ((travel_lmt == -1) ||
-                    (val < travel_lmt))
+                if (!bounds.is_p_inside(new_p) ||
+                    (new_p == p0))
                 {
-                    out[new_p.x][new_p.y] = val + 1;
+                    continue;
                 }
 
-                if (is_stopping_at_tgt && new_p == p1)
+                const int new_p_cost = cost[new_p.x][new_p.y];
+
+                if (new_p_cost < 1)
                 {
-                    is_at_tgt = true;
-                    break;
+                    // Blocked
+                    continue;
                 }
 
-                if (!is_stopping_at_tgt || !is_at_tgt)
+                const int new_val = val + new_p_cost;
+
+                if ((travel_lmt != -1) && (new_val > travel_lmt))
                 {
-                    positions.push_back(new_p);
+                    continue;
+                }
+
+                int& new_p_out = out[new_p.x][new_p.y];
+
+                if ((new_p_out == 0) || (new_val < new_p_out))
+                {
+                    new_p_out = new_val;
+
+                    buckets[new_val % buckets.size()].push_back(new_p);
+
+                    ++nr_queued;
                 }
             }
-        } // Offset loop
+        }
+
+        bucket.clear();
+    }
+}
+
+void floodfill_multi(const std::vector<P>& origins,
+                     const bool blocked[map_w][map_h],
+                     int out[map_w][map_h],
+                     int travel_lmt,
+                     const bool allow_diagonal)
+{
+    std::vector<PosVal> origin_vals;
+
+    origin_vals.reserve(origins.size());
+
+    for (const P& p : origins)
+    {
+        origin_vals.emplace_back(PosVal(p, 0));
+    }
+
+    floodfill_multi(origin_vals,
+                    blocked,
+                    out,
+                    nullptr,
+                    travel_lmt,
+                    allow_diagonal);
+}
+
+void floodfill_multi(const std::vector<PosVal>& origins,
+                     const bool blocked[map_w][map_h],
+                     int out[map_w][map_h],
+                     int nearest_origin[map_w][map_h],
+                     int travel_lmt,
+                     const bool allow_diagonal)
+{
+    std::fill_n(*out, nr_map_cells, 0);
 
-        if (is_stopping_at_tgt)
+    // Zero is both a valid value and the "unreached" marker in the output, so
+    // we track which origin reached each cell separately
+    int origin_idx_buffer[map_w][map_h];
+
+    int (*origin_idx)[map_h] =
+        nearest_origin ?
+        nearest_origin :
+        origin_idx_buffer;
+
+    std::fill_n(*origin_idx, nr_map_cells, -1);
+
+    // The origins are visited in order of their starting value, merged with the
+    // positions found by flooding (which are always added in increasing order)
+    std::vector<size_t> sorted_origins(origins.size());
+
+    std::iota(begin(sorted_origins), end(sorted_origins), 0);
+
+    std::stable_sort(
+        begin(sorted_origins),
+        end(sorted_origins),
+        [&](const size_t i0, const size_t i1)
         {
-            if (positions.size() == next_p_idx)
-            {
-                path_exists = false;
-            }
+            return origins[i0].val < origins[i1].val;
+        });
+
+    size_t next_origin_idx = 0;
+
+    std::vector<P> positions;
+
+    positions.reserve(nr_map_cells);
+
+    size_t next_p_idx = 0;
 
-            if (is_at_tgt || !path_exists)
+    const R& bounds = flood_bfs::map_flood_bounds;
+
+    const auto& dirs =
+        allow_diagonal ?
+        dir_utils::dir_list :
+        dir_utils::cardinal_list;
+
+    while (true)
+    {
+        // Pick whichever of the next origin or next flooded position has the
+        // lowest value
+        P p;
+
+        const bool is_origin_left = next_origin_idx < sorted_origins.size();
+
+        const bool is_pos_left = next_p_idx < positions.size();
+
+        if (!is_origin_left && !is_pos_left)
+        {
+            break;
+        }
+
+        if (is_origin_left &&
+            (!is_pos_left ||
+             (origins[sorted_origins[next_origin_idx]].val <=
+              out[positions[next_p_idx].x][positions[next_p_idx].y])))
+        {
+            const size_t idx = sorted_origins[next_origin_idx];
+
+            ++next_origin_idx;
+
+            const PosVal& origin = origins[idx];
+
+            p = origin.pos;
+
+            if ((origin_idx[p.x][p.y] != -1) &&
+                (out[p.x][p.y] <= origin.val))
             {
-                done = true;
+                // Already reached at a lower (or the same) value
+                continue;
             }
+
+            out[p.x][p.y] = origin.val;
+
+            origin_idx[p.x][p.y] = idx;
         }
-        else if (positions.size() == next_p_idx)
+        else
         {
-            done = true;
+            p = positions[next_p_idx];
+
+            ++next_p_idx;
         }
 
-        if (val == travel_lmt)
+        const int val = out[p.x][p.y];
+
+        if ((travel_lmt != -1) && (val >= travel_lmt))
         {
-            done = true;
+            continue;
         }
 
-        if (!is_stopping_at_tgt || !is_at_tgt)
+        for (const P& d : dirs)
         {
-            if (positions.size() == next_p_idx)
-            {
-                // No more positions to evaluate
-                path_exists = false;
-            }
-            else // There are more positions to evaluate
+            const P new_p(p + d);
+
+            if (bounds.is_p_inside(new_p) &&
+                !blocked[new_p.x][new_p.y] &&
+                (origin_idx[new_p.x][new_p.y] == -1))
             {
-                p = positions[next_p_idx];
+                out[new_p.x][new_p.y] = val + 1;
+
+                origin_idx[new_p.x][new_p.y] = origin_idx[p.x][p.y];
 
-                ++next_p_idx;
+                positions.push_back(new_p);
             }
         }
-    } // while
+    }
 }
@@ -0,0 +1,96 @@
+#ifndef RL_UTILS_FLOOD_BFS_HPP
+#define RL_UTILS_FLOOD_BFS_HPP
+
+#include <vector>
+
+// NOTE: This is an internal header for the RL Utils sources, it is not included
+// by rl_utils.hpp (but it expects rl_utils.hpp to be included before it)
+
+namespace flood_bfs
+{
+
+// NOTE: The outermost cells of the map are never flooded, or entered by any of
+// the pathfinding algorithms
+const R map_flood_bounds(P(1, 1), P(map_w, map_h) - 2);
+
+enum class StepResult
+{
+    expanded,
+    tgt_reached,
+    done
+};
+
+// One step of the breadth first search used by floodfill: expands the next
+// position in "positions" (the index of which is "next_p_idx"), by flooding
+// all free neighbours and adding them to the end of "positions". The search
+// is started by putting only the origin in "positions", and can be resumed at
+// any time, as long as the arguments are the same between steps.
+//
+// "Vals" is the storage of the flood values, where all values are expected to
+// be zero initially - this is either a grid view, or a search context. Only
+// positions inside "bounds" are flooded. If "p1" is not (-1, -1), the search
+// is finished as soon as the value of "p1" is set.
+template<typename Vals>
+StepResult expand_next(const P& p0,
+                       const GridView<const bool>& blocked,
+                       Vals& vals,
+                       const int travel_lmt,
+                       const P& p1,
+                       const bool allow_diagonal,
+                       std::vector<P>& positions,
+                       size_t& next_p_idx,
+                       const R& bounds)
+{
+    if (next_p_idx == positions.size())
+    {
+        // No more positions to evaluate
+        return StepResult::done;
+    }
+
+    // NOTE: Copied, since adding positions may reallocate the vector
+    const P p(positions[next_p_idx]);
+
+    ++next_p_idx;
+
+    const int val = vals.val(p);
+
+    // Positions are expanded in order of increasing value, so no more
+    // positions can be flooded after reaching the travel limit
+    if ((travel_lmt != -1) && (val >= travel_lmt))
+    {
+        return StepResult::done;
+    }
+
+    const auto& dirs =
+        allow_diagonal ?
+        dir_utils::dir_list :
+        dir_utils::cardinal_list;
+
+    for (const P& d : dirs)
+    {
+        const P new_p(p + d);
+
+        if (!bounds.is_p_inside(new_p) ||
+            blocked(new_p) ||
+            (vals.val(new_p) != 0) ||
+            (new_p == p0))
+        {
+            continue;
+        }
+
+        vals.set_val(new_p, val + 1);
+
+        if (new_p == p1)
+        {
+            return StepResult::tgt_reached;
+        }
+
+        positions.push_back(new_p);
+    }
+
+    return StepResult::expanded;
+}
+
+} // flood_bfs
+
+#endif // RL_UTILS_FLOOD_BFS_HPP
@@ -0,0 +1,257 @@
+#include "rl_utils.hpp"
+
+#include <climits>
+
+#include "flood_bfs.hpp"
+
+FloodField::FloodField(const P& p0,
+                       const bool blocked[map_w][map_h],
+                       const bool allow_diagonal) :
+    p0_     (p0),
+    dirs_   (allow_diagonal ?
+             dir_utils::dir_list :
+             dir_utils::cardinal_list)
+{
+    std::copy_n(*blocked, nr_map_cells, *blocked_);
+
+    floodfill(p0_,
+              blocked_,
+              flood_,
+              -1,
+              P(-1, -1),
+              allow_diagonal);
+}
+
+void FloodField::set_blocked(const P& p, const bool is_blocked)
+{
+    if (blocked_[p.x][p.y] == is_blocked)
+    {
+        return;
+    }
+
+    blocked_[p.x][p.y] = is_blocked;
+
+    // NOTE: The origin is never treated as blocked (same as for floodfill)
+    if ((p == p0_) || !flood_bfs::map_flood_bounds.is_p_inside(p))
+    {
+        return;
+    }
+
+    if (is_blocked)
+    {
+        on_blocked(p);
+    }
+    else
+    {
+        on_unblocked(p);
+    }
+}
+
+bool FloodField::can_flood_to(const P& p) const
+{
+    return
+        flood_bfs::map_flood_bounds.is_p_inside(p) &&
+        !blocked_[p.x][p.y] &&
+        (p != p0_);
+}
+
+bool FloodField::set_from_adj(const P& p)
+{
+    int lowest_adj_val = INT_MAX;
+
+    for (const P& d : dirs_)
+    {
+        const P adj_p(p + d);
+
+        if (is_reached(adj_p))
+        {
+            lowest_adj_val = std::min(lowest_adj_val, flood_[adj_p.x][adj_p.y]);
+        }
+    }
+
+    if (lowest_adj_val == INT_MAX)
+    {
+        return false;
+    }
+
+    flood_[p.x][p.y] = lowest_adj_val + 1;
+
+    return true;
+}
+
+void FloodField::flood_from(std::vector<P>& seeds)
+{
+    // The seeds may have different values, so they are visited in order of
+    // value, merged with the positions found by flooding (which are always
+    // added in increasing order).
+    std::sort(
+        begin(seeds),
+        end(seeds),
+        [&](const P& p0, const P& p1)
+        {
+            return flood_[p0.x][p0.y] < flood_[p1.x][p1.y];
+        });
+
+    size_t next_seed_idx = 0;
+
+    std::vector<P> positions;
+
+    size_t next_p_idx = 0;
+
+    while (true)
+    {
+        const bool is_seed_left = next_seed_idx < seeds.size();
+
+        const bool is_pos_left = next_p_idx < positions.size();
+
+        if (!is_seed_left && !is_pos_left)
+        {
+            break;
+        }
+
+        P p;
+
+        if (is_seed_left &&
+            (!is_pos_left ||
+             (flood_[seeds[next_seed_idx].x][seeds[next_seed_idx].y] <=
+              flood_[positions[next_p_idx].x][positions[next_p_idx].y])))
+        {
+            p = seeds[next_seed_idx];
+
+            ++next_seed_idx;
+        }
+        else
+        {
+            p = positions[next_p_idx];
+
+            ++next_p_idx;
+        }
+
+        const int new_val = flood_[p.x][p.y] + 1;
+
+        for (const P& d : dirs_)
+        {
+            const P new_p(p + d);
+
+            if (!can_flood_to(new_p))
+            {
+                continue;
+            }
+
+            int& new_p_val = flood_[new_p.x][new_p.y];
+
+            if ((new_p_val == 0) || (new_val < new_p_val))
+            {
+                new_p_val = new_val;
+
+                positions.push_back(new_p);
+            }
+        }
+    }
+}
+
+void FloodField::on_blocked(const P& p)
+{
+    const int blocked_val = flood_[p.x][p.y];
+
+    flood_[p.x][p.y] = 0;
+
+    if (blocked_val == 0)
+    {
+        // The cell was not reached, so no paths went through it
+        return;
+    }
+
+    // Find all cells which can no longer be reached in the same number of
+    // steps, i.e. cells which have no remaining neighbour one step closer to
+    // the origin. These are checked in order of increasing value, so that a
+    // cell is only checked after all cells closer to the origin.
+    std::vector<P> candidates;
+
+    size_t next_candidate_idx = 0;
+
+    std::vector<P> lost;
+
+    auto add_candidates = [&](const P& from_p, const int from_val)
+    {
+        for (const P& d : dirs_)
+        {
+            const P adj_p(from_p + d);
+
+            if (can_flood_to(adj_p) &&
+                (flood_[adj_p.x][adj_p.y] == (from_val + 1)))
+            {
+                candidates.push_back(adj_p);
+            }
+        }
+    };
+
+    add_candidates(p, blocked_val);
+
+    while (next_candidate_idx < candidates.size())
+    {
+        const P candidate = candidates[next_candidate_idx];
+
+        ++next_candidate_idx;
+
+        const int val = flood_[candidate.x][candidate.y];
+
+        if (val == 0)
+        {
+            // Already lost
+            continue;
+        }
+
+        bool is_supported = false;
+
+        for (const P& d : dirs_)
+        {
+            const P adj_p(candidate + d);
+
+            if (is_reached(adj_p) &&
+                (flood_[adj_p.x][adj_p.y] == (val - 1)))
+            {
+                is_supported = true;
+                break;
+            }
+        }
+
+        if (is_supported)
+        {
+            continue;
+        }
+
+        flood_[candidate.x][candidate.y] = 0;
+
+        lost.push_back(candidate);
+
+        add_candidates(candidate, val);
+    }
+
+    // Assign new values to the lost cells from their reached neighbours (if
+    // any), and flood out from there
+    std::vector<P> seeds;
+
+    for (const P& lost_p : lost)
+    {
+        if (set_from_adj(lost_p))
+        {
+            seeds.push_back(lost_p);
+        }
+    }
+
+    flood_from(seeds);
+}
+
+void FloodField::on_unblocked(const P& p)
+{
+    if (!set_from_adj(p))
+    {
+        // Not reachable from the origin
+        return;
+    }
+
+    std::vector<P> seeds(1, p);
+
+    flood_from(seeds);
+}
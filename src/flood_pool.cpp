@@ -0,0 +1,153 @@
+#include "rl_utils.hpp"
+
+FloodPool::FloodPool(const int nr_threads) :
+    threads_        (),
+    ctxs_           (),
+    mutex_          (),
+    work_cond_      (),
+    done_cond_      (),
+    batch_nr_       (0),
+    nr_threads_done_(0),
+    is_stopping_    (false),
+    reqs_           (nullptr),
+    blocked_        (nullptr),
+    next_req_idx_   (0)
+{
+    int nr_threads_used = nr_threads;
+
+    if (nr_threads_used <= 0)
+    {
+        nr_threads_used = (int)std::thread::hardware_concurrency() - 1;
+
+        nr_threads_used = std::max(0, nr_threads_used);
+    }
+
+    for (int i = 0; i <= nr_threads_used; ++i)
+    {
+        ctxs_.emplace_back(new SearchCtx);
+    }
+
+    for (int i = 0; i < nr_threads_used; ++i)
+    {
+        threads_.emplace_back(&FloodPool::worker_loop, this, i);
+    }
+}
+
+FloodPool::~FloodPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        is_stopping_ = true;
+    }
+
+    work_cond_.notify_all();
+
+    for (std::thread& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+void FloodPool::run(const std::vector<FloodReq>& reqs,
+                    const bool blocked[map_w][map_h])
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        reqs_ = &reqs;
+        blocked_ = blocked;
+        next_req_idx_ = 0;
+        nr_threads_done_ = 0;
+
+        ++batch_nr_;
+    }
+
+    work_cond_.notify_all();
+
+    run_reqs(*ctxs_.back());
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    done_cond_.wait(
+        lock,
+        [&]()
+        {
+            return nr_threads_done_ == threads_.size();
+        });
+
+    reqs_ = nullptr;
+    blocked_ = nullptr;
+}
+
+void FloodPool::worker_loop(const size_t worker_idx)
+{
+    SearchCtx& ctx = *ctxs_[worker_idx];
+
+    uint64_t last_batch_nr = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            work_cond_.wait(
+                lock,
+                [&]()
+                {
+                    return is_stopping_ || (batch_nr_ != last_batch_nr);
+                });
+
+            if (is_stopping_)
+            {
+                return;
+            }
+
+            last_batch_nr = batch_nr_;
+        }
+
+        run_reqs(ctx);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            ++nr_threads_done_;
+        }
+
+        done_cond_.notify_one();
+    }
+}
+
+void FloodPool::run_reqs(SearchCtx& ctx)
+{
+    const std::vector<FloodReq>& reqs = *reqs_;
+
+    while (true)
+    {
+        const size_t idx = next_req_idx_.fetch_add(1);
+
+        if (idx >= reqs.size())
+        {
+            break;
+        }
+
+        const FloodReq& req = reqs[idx];
+
+        floodfill(ctx,
+                  req.p0,
+                  blocked_,
+                  req.out,
+                  req.travel_lmt,
+                  req.p1,
+                  req.allow_diagonal);
+    }
+}
+
+void floodfill_batch(const std::vector<FloodReq>& reqs,
+                     const bool blocked[map_w][map_h],
+                     const int nr_threads)
+{
+    FloodPool pool(nr_threads);
+
+    pool.run(reqs, blocked);
+}
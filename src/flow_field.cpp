@@ -0,0 +1,121 @@
+#include "rl_utils.hpp"
+
+void flow_field(const P& goal,
+                const GridView<const int>& flood,
+                const GridView<Dir>& out,
+                const bool allow_diagonal,
+                const bool randomize_steps)
+{
+    ASSERT(flood.dims() == out.dims());
+
+    const std::vector<P>& dirs = allow_diagonal ?
+                                 dir_utils::dir_list :
+                                 dir_utils::cardinal_list;
+
+    const size_t nr_dirs = dirs.size();
+
+    // Corresponds to the elements in "dirs"
+    Dir dir_enums[8];
+
+    for (size_t i = 0; i < nr_dirs; ++i)
+    {
+        dir_enums[i] = dir_utils::dir(dirs[i]);
+    }
+
+    const P& dims = flood.dims();
+
+    const R grid_r(P(0, 0), dims - 1);
+
+    for (int x = 0; x < dims.x; ++x)
+    {
+        for (int y = 0; y < dims.y; ++y)
+        {
+            const P p(x, y);
+
+            const int current_val = flood(p);
+
+            if ((current_val == 0) || (p == goal))
+            {
+                // Goal cell, or not reached
+                out(p) = Dir::center;
+
+                continue;
+            }
+
+            int lowest_adj_val = current_val;
+
+            // Set if the goal is adjacent - this is always the best choice
+            int goal_dir_idx = -1;
+
+            int adj_vals[8];
+
+            for (size_t i = 0; i < nr_dirs; ++i)
+            {
+                const P adj_p(p + dirs[i]);
+
+                if (adj_p == goal)
+                {
+                    goal_dir_idx = (int)i;
+
+                    break;
+                }
+
+                adj_vals[i] =
+                    grid_r.is_p_inside(adj_p) ?
+                    flood(adj_p) :
+                    0;
+
+                if ((adj_vals[i] != 0) && (adj_vals[i] < lowest_adj_val))
+                {
+                    lowest_adj_val = adj_vals[i];
+                }
+            }
+
+            if (goal_dir_idx >= 0)
+            {
+                out(p) = dir_enums[goal_dir_idx];
+
+                continue;
+            }
+
+            // Collect the directions to the lowest adjacent value which is
+            // closer to the goal than the current cell
+            int valid_idxs[8];
+
+            int nr_valid = 0;
+
+            for (size_t i = 0; i < nr_dirs; ++i)
+            {
+                if ((adj_vals[i] != 0) &&
+                    (adj_vals[i] == lowest_adj_val) &&
+                    (adj_vals[i] < current_val))
+                {
+                    valid_idxs[nr_valid] = (int)i;
+
+                    ++nr_valid;
+
+                    if (!randomize_steps)
+                    {
+                        // Use the first valid direction
+                        break;
+                    }
+                }
+            }
+
+            if (nr_valid == 0)
+            {
+                // Should not happen for a proper floodfill
+                out(p) = Dir::center;
+
+                continue;
+            }
+
+            const int idx =
+                randomize_steps ?
+                valid_idxs[rnd::range(0, nr_valid - 1)] :
+                valid_idxs[0];
+
+            out(p) = dir_enums[idx];
+        }
+    }
+}
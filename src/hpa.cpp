@@ -0,0 +1,784 @@
+#include "rl_utils.hpp"
+
+#include <queue>
+
+#include "flood_bfs.hpp"
+
+namespace
+{
+
+// Entrances at least this long get one transition at each end, instead of a
+// single transition in the middle
+const int long_entrance_len = 6;
+
+struct AbstractNode
+{
+    AbstractNode(const int node_idx, const int g, const int f) :
+        node_idx    (node_idx),
+        g           (g),
+        f           (f) {}
+
+    int node_idx;
+    int g;
+    int f;
+};
+
+struct AbstractNodeCmp
+{
+    bool operator()(const AbstractNode& n0, const AbstractNode& n1) const
+    {
+        if (n0.f != n1.f)
+        {
+            return n0.f > n1.f;
+        }
+
+        return n0.g < n1.g;
+    }
+};
+
+} // namespace
+
+HpaGraph::HpaGraph(const bool blocked[map_w][map_h],
+                   const int cluster_size,
+                   const bool allow_diagonal) :
+    cluster_size_   (cluster_size),
+    nr_clusters_x_  ((map_w + cluster_size - 1) / cluster_size),
+    nr_clusters_y_  ((map_h + cluster_size - 1) / cluster_size),
+    allow_diagonal_ (allow_diagonal),
+    nodes_          (),
+    free_node_idxs_ (),
+    cluster_nodes_  (nr_clusters_x_ * nr_clusters_y_),
+    ctx_            ()
+{
+    ASSERT(cluster_size_ > 1);
+
+    std::copy_n(*blocked, nr_map_cells, *blocked_);
+
+    std::fill_n(*mask_, nr_map_cells, true);
+
+    const int nr_clusters = nr_clusters_x_ * nr_clusters_y_;
+
+    for (int i = 0; i < nr_clusters; ++i)
+    {
+        add_transitions_to(i, P(1, 0));
+        add_transitions_to(i, P(0, 1));
+        add_transitions_to(i, P(1, 1));
+        add_transitions_to(i, P(-1, 1));
+    }
+
+    for (int i = 0; i < nr_clusters; ++i)
+    {
+        connect_cluster(i);
+    }
+}
+
+void HpaGraph::rebuild_cluster(const P& p, const bool blocked[map_w][map_h])
+{
+    const int idx = cluster_idx(p);
+
+    const R r(cluster_r(idx));
+
+    for (int x = r.p0.x; x <= r.p1.x; ++x)
+    {
+        for (int y = r.p0.y; y <= r.p1.y; ++y)
+        {
+            blocked_[x][y] = blocked[x][y];
+        }
+    }
+
+    // Remove all transitions which depend on cells in this cluster - that is
+    // transitions to the neighbouring clusters, and corner transitions between
+    // neighbours where the crossing could be made through this cluster
+    const P cluster_p(cluster_pos(idx));
+
+    std::vector<int> adj_clusters;
+
+    for (const P& d : dir_utils::dir_list)
+    {
+        const int adj_idx = cluster_idx_at(cluster_p + d);
+
+        if (adj_idx != -1)
+        {
+            adj_clusters.push_back(adj_idx);
+
+            remove_transitions(idx, adj_idx);
+        }
+    }
+
+    const P corner_pairs[4][2] =
+    {
+        {P(-1, 0), P(0, -1)},
+        {P(1, 0), P(0, -1)},
+        {P(-1, 0), P(0, 1)},
+        {P(1, 0), P(0, 1)}
+    };
+
+    for (const auto& corner_pair : corner_pairs)
+    {
+        const int adj_idx_0 = cluster_idx_at(cluster_p + corner_pair[0]);
+        const int adj_idx_1 = cluster_idx_at(cluster_p + corner_pair[1]);
+
+        if ((adj_idx_0 != -1) && (adj_idx_1 != -1))
+        {
+            remove_transitions(adj_idx_0, adj_idx_1);
+
+            add_transitions_to(adj_idx_0, corner_pair[1] - corner_pair[0]);
+        }
+    }
+
+    const std::vector<int> old_nodes = cluster_nodes_[idx];
+
+    for (const int node_idx : old_nodes)
+    {
+        remove_node(node_idx);
+    }
+
+    for (const P& d : dir_utils::dir_list)
+    {
+        add_transitions_to(idx, d);
+    }
+
+    connect_cluster(idx);
+
+    for (const int adj_idx : adj_clusters)
+    {
+        connect_cluster(adj_idx);
+    }
+}
+
+bool HpaGraph::pathfind_abstract(const P& p0,
+                                 const P& p1,
+                                 std::vector<P>& out)
+{
+    out.clear();
+
+    if ((p0 == p1) || !is_free(p1))
+    {
+        return false;
+    }
+
+    const int cluster_0 = cluster_idx(p0);
+    const int cluster_1 = cluster_idx(p1);
+
+    // The origin may be blocked (e.g. by the monster standing there), so it is
+    // always treated as free
+    set_cluster_masked(cluster_0, false);
+
+    mask_[p0.x][p0.y] = false;
+
+    floodfill(ctx_, p0, mask_, -1, P(-1, -1), allow_diagonal_);
+
+    std::vector<Edge> start_edges;
+
+    // For each start edge, a first step into another cluster (if any)
+    std::vector<P> start_vias;
+
+    for (const int node_idx : cluster_nodes_[cluster_0])
+    {
+        const P& node_p = nodes_[node_idx].p;
+
+        if ((node_p == p0) || (ctx_.val(node_p) != 0))
+        {
+            start_edges.push_back(Edge(node_idx, ctx_.val(node_p), false));
+
+            start_vias.push_back(P(-1, -1));
+        }
+    }
+
+    const int direct_cost =
+        (cluster_0 == cluster_1) ?
+        ctx_.val(p1) :
+        0;
+
+    set_cluster_masked(cluster_0, true);
+
+    // If the origin is blocked, there are no transitions from it into other
+    // clusters, so it must be connected to the nodes of neighbouring clusters
+    // which can be reached by stepping directly out of the origin
+    if (!is_free(p0))
+    {
+        const std::vector<P>& dirs = allow_diagonal_ ?
+                                     dir_utils::dir_list :
+                                     dir_utils::cardinal_list;
+
+        for (const P& d : dirs)
+        {
+            const P via(p0 + d);
+
+            const int via_cluster = cluster_idx(via);
+
+            if ((via_cluster == cluster_0) || !is_free(via))
+            {
+                continue;
+            }
+
+            set_cluster_masked(via_cluster, false);
+
+            floodfill(ctx_, via, mask_, -1, P(-1, -1), allow_diagonal_);
+
+            for (const int node_idx : cluster_nodes_[via_cluster])
+            {
+                const P& node_p = nodes_[node_idx].p;
+
+                if ((node_p == via) || (ctx_.val(node_p) != 0))
+                {
+                    start_edges.push_back(
+                        Edge(node_idx, ctx_.val(node_p) + 1, false));
+
+                    start_vias.push_back(via);
+                }
+            }
+
+            set_cluster_masked(via_cluster, true);
+        }
+    }
+
+    set_cluster_masked(cluster_1, false);
+
+    floodfill(ctx_, p1, mask_, -1, P(-1, -1), allow_diagonal_);
+
+    std::vector<Edge> goal_edges;
+
+    for (const int node_idx : cluster_nodes_[cluster_1])
+    {
+        const P& node_p = nodes_[node_idx].p;
+
+        if ((node_p == p1) || (ctx_.val(node_p) != 0))
+        {
+            goal_edges.push_back(Edge(node_idx, ctx_.val(node_p), false));
+        }
+    }
+
+    set_cluster_masked(cluster_1, true);
+
+    // Search the graph, with two extra nodes for the origin and target
+    const int start_idx = nodes_.size();
+    const int goal_idx = start_idx + 1;
+
+    auto node_p = [&](const int node_idx)
+    {
+        return
+            (node_idx == start_idx) ? p0 :
+            (node_idx == goal_idx) ? p1 :
+            nodes_[node_idx].p;
+    };
+
+    auto heuristic = [&](const int node_idx)
+    {
+        return allow_diagonal_ ?
+            king_dist(node_p(node_idx), p1) :
+            taxi_dist(node_p(node_idx), p1);
+    };
+
+    std::vector<int> g(goal_idx + 1, -1);
+
+    std::vector<int> parents(goal_idx + 1, -1);
+
+    std::priority_queue<AbstractNode,
+                        std::vector<AbstractNode>,
+                        AbstractNodeCmp> open;
+
+    g[start_idx] = 0;
+
+    open.push(AbstractNode(start_idx, 0, heuristic(start_idx)));
+
+    // Returns true if this was a better way to the node
+    auto try_edge = [&](const int from_idx, const int to_idx, const int cost)
+    {
+        const int new_g = g[from_idx] + cost;
+
+        if ((g[to_idx] == -1) || (new_g < g[to_idx]))
+        {
+            g[to_idx] = new_g;
+
+            parents[to_idx] = from_idx;
+
+            open.push(AbstractNode(to_idx, new_g, new_g + heuristic(to_idx)));
+
+            return true;
+        }
+
+        return false;
+    };
+
+    // Step out of the origin used for reaching each node directly from the
+    // origin, if any
+    std::vector<P> start_via_used(start_idx, P(-1, -1));
+
+    bool is_at_goal = false;
+
+    while (!open.empty())
+    {
+        const AbstractNode current = open.top();
+
+        open.pop();
+
+        const int current_idx = current.node_idx;
+
+        if (current_idx == goal_idx)
+        {
+            is_at_goal = true;
+            break;
+        }
+
+        if (current.g > g[current_idx])
+        {
+            continue;
+        }
+
+        if (current_idx == start_idx)
+        {
+            for (size_t i = 0; i < start_edges.size(); ++i)
+            {
+                const Edge& e = start_edges[i];
+
+                if (try_edge(current_idx, e.node_idx, e.cost))
+                {
+                    start_via_used[e.node_idx] = start_vias[i];
+                }
+            }
+
+            if (direct_cost != 0)
+            {
+                try_edge(current_idx, goal_idx, direct_cost);
+            }
+
+            continue;
+        }
+
+        const Node& node = nodes_[current_idx];
+
+        for (const Edge& e : node.edges)
+        {
+            try_edge(current_idx, e.node_idx, e.cost);
+        }
+
+        if (node.cluster_idx == cluster_1)
+        {
+            for (const Edge& e : goal_edges)
+            {
+                if (e.node_idx == current_idx)
+                {
+                    try_edge(current_idx, goal_idx, e.cost);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!is_at_goal)
+    {
+        return false;
+    }
+
+    for (int node_idx = goal_idx; node_idx != -1; node_idx = parents[node_idx])
+    {
+        if ((parents[node_idx] == start_idx) &&
+            (node_idx != goal_idx) &&
+            (start_via_used[node_idx].x != -1))
+        {
+            out.push_back(node_p(node_idx));
+
+            out.push_back(start_via_used[node_idx]);
+
+            continue;
+        }
+
+        const P& p = node_p(node_idx);
+
+        // Nodes may be placed at the origin or target
+        if (out.empty() || (out.back() != p))
+        {
+            out.push_back(p);
+        }
+    }
+
+    // Remove duplicates again (a step out of the origin may be a node)
+    out.erase(std::unique(begin(out), end(out)), end(out));
+
+    std::reverse(begin(out), end(out));
+
+    return true;
+}
+
+void HpaGraph::refine(const P& p0, const P& p1, std::vector<P>& out)
+{
+    out.clear();
+
+    if (p0 == p1)
+    {
+        return;
+    }
+
+    const int cluster_0 = cluster_idx(p0);
+
+    if (cluster_0 != cluster_idx(p1))
+    {
+        // Transition between two clusters
+        ASSERT(is_pos_adj(p0, p1, false));
+
+        out.push_back(p1);
+
+        return;
+    }
+
+    set_cluster_masked(cluster_0, false);
+
+    mask_[p0.x][p0.y] = false;
+
+    ::pathfind(ctx_, p0, p1, mask_, out, allow_diagonal_, false);
+
+    set_cluster_masked(cluster_0, true);
+
+    mask_[p0.x][p0.y] = true;
+}
+
+void HpaGraph::pathfind(const P& p0, const P& p1, std::vector<P>& out)
+{
+    out.clear();
+
+    std::vector<P> waypoints;
+
+    if (!pathfind_abstract(p0, p1, waypoints))
+    {
+        return;
+    }
+
+    std::vector<P> segment;
+
+    for (size_t i = waypoints.size() - 1; i > 0; --i)
+    {
+        refine(waypoints[i - 1], waypoints[i], segment);
+
+        out.insert(end(out), begin(segment), end(segment));
+    }
+}
+
+int HpaGraph::cluster_idx_at(const P& cluster_p) const
+{
+    if ((cluster_p.x < 0) ||
+        (cluster_p.y < 0) ||
+        (cluster_p.x >= nr_clusters_x_) ||
+        (cluster_p.y >= nr_clusters_y_))
+    {
+        return -1;
+    }
+
+    return (cluster_p.y * nr_clusters_x_) + cluster_p.x;
+}
+
+R HpaGraph::cluster_r(const int cluster_idx) const
+{
+    const P p0(cluster_pos(cluster_idx) * cluster_size_);
+
+    const P p1(std::min(p0.x + cluster_size_, map_w) - 1,
+               std::min(p0.y + cluster_size_, map_h) - 1);
+
+    return R(p0, p1);
+}
+
+bool HpaGraph::is_free(const P& p) const
+{
+    return
+        flood_bfs::map_flood_bounds.is_p_inside(p) &&
+        !blocked_[p.x][p.y];
+}
+
+void HpaGraph::set_cluster_masked(const int cluster_idx, const bool is_masked)
+{
+    const R r(cluster_r(cluster_idx));
+
+    for (int x = r.p0.x; x <= r.p1.x; ++x)
+    {
+        for (int y = r.p0.y; y <= r.p1.y; ++y)
+        {
+            mask_[x][y] = is_masked || blocked_[x][y];
+        }
+    }
+}
+
+int HpaGraph::add_node(const P& p)
+{
+    const int c_idx = cluster_idx(p);
+
+    for (const int node_idx : cluster_nodes_[c_idx])
+    {
+        if (nodes_[node_idx].p == p)
+        {
+            return node_idx;
+        }
+    }
+
+    int node_idx = 0;
+
+    if (free_node_idxs_.empty())
+    {
+        node_idx = nodes_.size();
+
+        nodes_.push_back(Node());
+    }
+    else
+    {
+        node_idx = free_node_idxs_.back();
+
+        free_node_idxs_.pop_back();
+    }
+
+    Node& node = nodes_[node_idx];
+
+    node.p = p;
+    node.cluster_idx = c_idx;
+    node.is_alive = true;
+    node.edges.clear();
+
+    cluster_nodes_[c_idx].push_back(node_idx);
+
+    return node_idx;
+}
+
+void HpaGraph::remove_node(const int node_idx)
+{
+    Node& node = nodes_[node_idx];
+
+    if (!node.is_alive)
+    {
+        return;
+    }
+
+    node.is_alive = false;
+    node.edges.clear();
+
+    std::vector<int>& c_nodes = cluster_nodes_[node.cluster_idx];
+
+    c_nodes.erase(std::remove(begin(c_nodes), end(c_nodes), node_idx),
+                  end(c_nodes));
+
+    free_node_idxs_.push_back(node_idx);
+}
+
+void HpaGraph::remove_transitions(const int cluster_idx_0,
+                                  const int cluster_idx_1)
+{
+    for (const int c_idx : {cluster_idx_0, cluster_idx_1})
+    {
+        const int other_c_idx =
+            (c_idx == cluster_idx_0) ?
+            cluster_idx_1 :
+            cluster_idx_0;
+
+        const std::vector<int> c_nodes = cluster_nodes_[c_idx];
+
+        for (const int node_idx : c_nodes)
+        {
+            std::vector<Edge>& edges = nodes_[node_idx].edges;
+
+            edges.erase(
+                std::remove_if(
+                    begin(edges),
+                    end(edges),
+                    [&](const Edge& e)
+                    {
+                        return
+                            e.is_inter &&
+                            (nodes_[e.node_idx].cluster_idx == other_c_idx);
+                    }),
+                end(edges));
+
+            const bool has_inter_edge =
+                std::any_of(
+                    begin(edges),
+                    end(edges),
+                    [](const Edge& e)
+                    {
+                        return e.is_inter;
+                    });
+
+            // NOTE: Other nodes in the cluster may still have edges to this
+            // node, the cluster must be connected again after this
+            if (!has_inter_edge)
+            {
+                remove_node(node_idx);
+            }
+        }
+    }
+}
+
+void HpaGraph::add_transition(const P& p0, const P& p1)
+{
+    const int node_idx_0 = add_node(p0);
+    const int node_idx_1 = add_node(p1);
+
+    nodes_[node_idx_0].edges.push_back(Edge(node_idx_1, 1, true));
+    nodes_[node_idx_1].edges.push_back(Edge(node_idx_0, 1, true));
+}
+
+void HpaGraph::add_border_transitions(const int cluster_idx_0,
+                                      const int cluster_idx_1)
+{
+    const R r0(cluster_r(cluster_idx_0));
+
+    const bool is_hor = cluster_pos(cluster_idx_1).x > cluster_pos(cluster_idx_0).x;
+
+    // Positions along the border, on each side of it
+    const int len = is_hor ? r0.h() : r0.w();
+
+    auto border_p = [&](const int side, const int i)
+    {
+        return is_hor ?
+            P(r0.p1.x + side, r0.p0.y + i) :
+            P(r0.p0.x + i, r0.p1.y + side);
+    };
+
+    auto is_crossing_free = [&](const int i)
+    {
+        return
+            is_free(border_p(0, i)) &&
+            is_free(border_p(1, i));
+    };
+
+    int run_begin = -1;
+
+    for (int i = 0; i <= len; ++i)
+    {
+        const bool is_crossing = (i < len) && is_crossing_free(i);
+
+        if (is_crossing && (run_begin == -1))
+        {
+            run_begin = i;
+        }
+        else if (!is_crossing && (run_begin != -1))
+        {
+            const int run_end = i - 1;
+
+            if ((run_end - run_begin + 1) >= long_entrance_len)
+            {
+                add_transition(border_p(0, run_begin), border_p(1, run_begin));
+                add_transition(border_p(0, run_end), border_p(1, run_end));
+            }
+            else
+            {
+                const int mid = (run_begin + run_end) / 2;
+
+                add_transition(border_p(0, mid), border_p(1, mid));
+            }
+
+            run_begin = -1;
+        }
+    }
+
+    if (!allow_diagonal_)
+    {
+        return;
+    }
+
+    // Diagonal crossings where no straight crossing is possible nearby (when
+    // there is a straight crossing next to a diagonal crossing, the cells on
+    // each side are connected within their clusters anyway)
+    for (int i = 0; i < (len - 1); ++i)
+    {
+        const bool free_0_0 = is_free(border_p(0, i));
+        const bool free_0_1 = is_free(border_p(0, i + 1));
+        const bool free_1_0 = is_free(border_p(1, i));
+        const bool free_1_1 = is_free(border_p(1, i + 1));
+
+        if (free_0_0 && free_1_1 && !free_0_1 && !free_1_0)
+        {
+            add_transition(border_p(0, i), border_p(1, i + 1));
+        }
+
+        if (free_0_1 && free_1_0 && !free_0_0 && !free_1_1)
+        {
+            add_transition(border_p(0, i + 1), border_p(1, i));
+        }
+    }
+}
+
+void HpaGraph::add_corner_transition(const int cluster_idx_0,
+                                     const int cluster_idx_1)
+{
+    const R r0(cluster_r(cluster_idx_0));
+
+    const bool is_right = cluster_pos(cluster_idx_1).x > cluster_pos(cluster_idx_0).x;
+
+    const P p0(is_right ? r0.p1.x : r0.p0.x, r0.p1.y);
+
+    const P p1(p0 + P(is_right ? 1 : -1, 1));
+
+    // Only needed if the crossing cannot be made through the side clusters
+    if (is_free(p0) &&
+        is_free(p1) &&
+        !is_free(P(p1.x, p0.y)) &&
+        !is_free(P(p0.x, p1.y)))
+    {
+        add_transition(p0, p1);
+    }
+}
+
+void HpaGraph::add_transitions_to(const int cluster_idx, const P& offset)
+{
+    const int adj_idx = cluster_idx_at(cluster_pos(cluster_idx) + offset);
+
+    if (adj_idx == -1)
+    {
+        return;
+    }
+
+    // Transitions are always added from the upper (or left) cluster
+    const bool is_reversed = (offset.y < 0) || ((offset.y == 0) && (offset.x < 0));
+
+    const int idx_0 = is_reversed ? adj_idx : cluster_idx;
+    const int idx_1 = is_reversed ? cluster_idx : adj_idx;
+
+    if ((offset.x != 0) && (offset.y != 0))
+    {
+        if (allow_diagonal_)
+        {
+            add_corner_transition(idx_0, idx_1);
+        }
+    }
+    else
+    {
+        add_border_transitions(idx_0, idx_1);
+    }
+}
+
+void HpaGraph::connect_cluster(const int cluster_idx)
+{
+    const std::vector<int>& c_nodes = cluster_nodes_[cluster_idx];
+
+    for (const int node_idx : c_nodes)
+    {
+        std::vector<Edge>& edges = nodes_[node_idx].edges;
+
+        edges.erase(
+            std::remove_if(
+                begin(edges),
+                end(edges),
+                [](const Edge& e)
+                {
+                    return !e.is_inter;
+                }),
+            end(edges));
+    }
+
+    set_cluster_masked(cluster_idx, false);
+
+    for (const int node_idx : c_nodes)
+    {
+        const P p(nodes_[node_idx].p);
+
+        floodfill(ctx_, p, mask_, -1, P(-1, -1), allow_diagonal_);
+
+        for (const int other_idx : c_nodes)
+        {
+            const int val = ctx_.val(nodes_[other_idx].p);
+
+            if ((other_idx != node_idx) && (val != 0))
+            {
+                nodes_[node_idx].edges.push_back(Edge(other_idx, val, false));
+            }
+        }
+    }
+
+    set_cluster_masked(cluster_idx, true);
+}
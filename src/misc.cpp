@@ -61,6 +61,30 @@ std::vector<P> to_vec(const bool a[map_w][map_h],
     return result;
 }
 
+std::vector<P> to_vec(const GridView<const bool>& a,
+                      const bool value_to_store)
+{
+    std::vector<P> result;
+
+    const P& dims = a.dims();
+
+    // Reserve space for worst case of push-backs
+    result.reserve(dims.x * dims.y);
+
+    for (int x = 0; x < dims.x; ++x)
+    {
+        for (int y = 0; y < dims.y; ++y)
+        {
+            if (a(x, y) == value_to_store)
+            {
+                result.emplace_back(P(x, y));
+            }
+        }
+    }
+
+    return result;
+}
+
 bool is_pos_inside(const P& pos, const R& area)
 {
     return
@@ -0,0 +1,148 @@
+#include "rl_utils.hpp"
+
+size_t PathCache::KeyHash::operator()(const Key& key) const
+{
+    size_t h = key.revision;
+
+    h = (h * 31) + key.p0.x;
+    h = (h * 31) + key.p0.y;
+    h = (h * 31) + key.p1.x;
+    h = (h * 31) + key.p1.y;
+    h = (h * 31) + (key.allow_diagonal ? 1 : 0);
+
+    return h;
+}
+
+PathCache::PathCache(const size_t max_nr_paths,
+                     const size_t max_nr_floods) :
+    revision_       (0),
+    paths_          (max_nr_paths),
+    floods_         (max_nr_floods),
+    path_stats_     (),
+    flood_stats_    () {}
+
+void PathCache::pathfind(const P& p0,
+                         const P& p1,
+                         const bool blocked[map_w][map_h],
+                         std::vector<P>& out,
+                         const bool allow_diagonal)
+{
+    const Key key(p0, p1, allow_diagonal, revision_);
+
+    const std::vector<P>* const cached = paths_.find(key);
+
+    if (cached)
+    {
+        ++path_stats_.nr_hits;
+
+        out = *cached;
+
+        return;
+    }
+
+    ++path_stats_.nr_misses;
+
+    ::pathfind(p0,
+               p1,
+               blocked,
+               out,
+               allow_diagonal,
+               false);
+
+    paths_.insert(key, std::vector<P>(out));
+}
+
+void PathCache::floodfill(const P& p0,
+                          const bool blocked[map_w][map_h],
+                          int out[map_w][map_h],
+                          const bool allow_diagonal)
+{
+    const Key key(p0, P(-1, -1), allow_diagonal, revision_);
+
+    const std::vector<int>* const cached = floods_.find(key);
+
+    if (cached)
+    {
+        ++flood_stats_.nr_hits;
+
+        std::copy(begin(*cached), end(*cached), *out);
+
+        return;
+    }
+
+    ++flood_stats_.nr_misses;
+
+    ::floodfill(p0,
+                blocked,
+                out,
+                -1,
+                P(-1, -1),
+                allow_diagonal);
+
+    floods_.insert(key, std::vector<int>(*out, *out + nr_map_cells));
+}
+
+void PathCache::invalidate_area(const R& area)
+{
+    const R map_r(P(0, 0), P(map_w, map_h) - 1);
+
+    // A result is affected if it touches a cell in the area, or next to the
+    // area (then a cell in the area may have been entered or blocked)
+    const R expanded_area(
+        P(std::max(area.p0.x - 1, map_r.p0.x),
+          std::max(area.p0.y - 1, map_r.p0.y)),
+        P(std::min(area.p1.x + 1, map_r.p1.x),
+          std::min(area.p1.y + 1, map_r.p1.y)));
+
+    paths_.erase_if(
+        [&](const Key& key, const std::vector<P>& path)
+        {
+            // There may now be a path where there was none before
+            if (path.empty())
+            {
+                return true;
+            }
+
+            // NOTE: The path does not include the origin
+            if (expanded_area.is_p_inside(key.p0) ||
+                expanded_area.is_p_inside(key.p1))
+            {
+                return true;
+            }
+
+            for (const P& p : path)
+            {
+                if (expanded_area.is_p_inside(p))
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        });
+
+    floods_.erase_if(
+        [&](const Key& key, const std::vector<int>& flood)
+        {
+            for (int x = expanded_area.p0.x; x <= expanded_area.p1.x; ++x)
+            {
+                for (int y = expanded_area.p0.y; y <= expanded_area.p1.y; ++y)
+                {
+                    if ((flood[(x * map_h) + y] != 0) ||
+                        (P(x, y) == key.p0))
+                    {
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        });
+}
+
+void PathCache::clear()
+{
+    paths_.clear();
+
+    floods_.clear();
+}
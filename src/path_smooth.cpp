@@ -0,0 +1,103 @@
+#include "rl_utils.hpp"
+
+#include "bresenham.hpp"
+
+namespace
+{
+
+bool is_line_clear(const P& p0,
+                   const P& p1,
+                   const bool blocked[map_w][map_h],
+                   std::vector<P>& line)
+{
+    bresenham(p0, p1, line);
+
+    for (const P& p : line)
+    {
+        if (blocked[p.x][p.y])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+void smooth_path(const P& p0,
+                 const std::vector<P>& path,
+                 const bool blocked[map_w][map_h],
+                 std::vector<P>& out)
+{
+    out.clear();
+
+    if (path.empty())
+    {
+        return;
+    }
+
+    std::vector<P> line;
+
+    // The path is walked from the origin, i.e. from the back of the path
+    // vector. The index of the last position which could be reached from the
+    // current anchor is tracked (the anchor starts at the origin).
+    P anchor(p0);
+
+    int reached_idx = (int)path.size() - 1;
+
+    // NOTE: The first step is always reachable from the anchor (it is adjacent)
+    int idx = reached_idx - 1;
+
+    while (idx >= 0)
+    {
+        if (is_line_clear(anchor, path[idx], blocked, line))
+        {
+            reached_idx = idx;
+
+            --idx;
+
+            continue;
+        }
+
+        // The previous reachable position becomes a waypoint and the new
+        // anchor - try from the same position again
+        anchor = path[reached_idx];
+
+        out.push_back(anchor);
+
+        // Positions on the path one step from the anchor are always
+        // reachable, so this always makes progress
+        reached_idx = idx;
+
+        --idx;
+    }
+
+    out.push_back(path[0]);
+
+    // Waypoints go from target to origin
+    std::reverse(begin(out), end(out));
+}
+
+void expand_waypoints(const P& p0,
+                      const std::vector<P>& waypoints,
+                      std::vector<P>& out)
+{
+    out.clear();
+
+    std::vector<P> line;
+
+    P anchor(p0);
+
+    for (auto it = waypoints.rbegin(); it != waypoints.rend(); ++it)
+    {
+        bresenham(anchor, *it, line);
+
+        out.insert(end(out), begin(line), end(line));
+
+        anchor = *it;
+    }
+
+    // The path goes from target to origin
+    std::reverse(begin(out), end(out));
+}
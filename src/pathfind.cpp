@@ -1,37 +1,51 @@
 #include "rl_utils.hpp"
 
-void pathfind(const P& p0,
-              const P& p1,
-              const bool blocked[map_w][map_h],
-              std::vector<P>& out,
-              const bool allow_diagonal,
-              const bool randomize_steps)
+#include "flood_bfs.hpp"
+
+namespace
 {
-    int flood[map_w][map_h];
 
-    floodfill(
-        p0,
-        blocked,
-        flood,
-        -1,
-        p1,
-        allow_diagonal);
+struct SearchNodeCmp
+{
+    bool operator()(const SearchNode& n0, const SearchNode& n1) const
+    {
+        // Lowest estimated total cost first - on ties, prefer the node which
+        // has traveled furthest (this reduces the number of expanded nodes)
+        if (n0.f != n1.f)
+        {
+            return n0.f > n1.f;
+        }
 
-    pathfind_with_flood(
-        p0,
-        p1,
-        flood,
-        out,
-        allow_diagonal,
-        randomize_steps);
-}
+        return n0.g < n1.g;
+    }
+};
 
-void pathfind_with_flood(const P& p0,
-                         const P& p1,
-                         const int flood[map_w][map_h],
-                         std::vector<P>& out,
-                         const bool allow_diagonal,
-                         const bool randomize_steps)
+// Flood value storage for plain arrays and grid views
+class ConstViewVals
+{
+public:
+    ConstViewVals(const GridView<const int>& vals) :
+        vals_(vals) {}
+
+    int val(const P& p) const
+    {
+        return vals_(p);
+    }
+
+private:
+    const GridView<const int> vals_;
+};
+
+// "Vals" is the storage of the flood values - either a grid view, or a search
+// context. "map_r" is the area covered by the flood values.
+template<typename Vals>
+void pathfind_with_flood_impl(const P& p0,
+                              const P& p1,
+                              const Vals& flood,
+                              std::vector<P>& out,
+                              const bool allow_diagonal,
+                              const bool randomize_steps,
+                              const R& map_r)
 {
     out.clear();
 
@@ -41,7 +55,7 @@ void pathfind_with_flood(const P& p0,
         return;
     }
 
-    if (flood[p1.x][p1.y] == 0)
+    if (flood.val(p1) == 0)
     {
         // No path exists
         return;
@@ -54,25 +68,31 @@ void pathfind_with_flood(const P& p0,
     const size_t nr_dirs = dirs.size();
 
     // Corresponds to the elements in "dirs"
-    std::vector<bool> valid_offsets(nr_dirs, false);
+    bool valid_offsets[8];
+
+    int adj_vals[8];
 
-    // The path length will be equal to the flood value at the target cell, so
-    // we can reserve that many elements beforehand.
-    out.reserve(flood[p1.x][p1.y]);
+    // The path is at least as long as the distance to the target (this is
+    // the exact length for an open map) - note that the flood value at the
+    // target cannot be used, since it is the total cost for a weighted flood.
+    out.reserve(
+        allow_diagonal ?
+        king_dist(p0, p1) :
+        taxi_dist(p0, p1));
 
     // We start at the target cell
     P p(p1);
     out.push_back(p);
 
-    const R map_r(P(0, 0), P(map_w, map_h) - 1);
-
     while (true)
     {
-        const int current_val = flood[p.x][p.y];
+        const int current_val = flood.val(p);
+
+        int lowest_adj_val = current_val;
 
         P adj_p;
 
-        // Find valid offsets, and check if origin is reached
+        // Find the lowest adjacent value, and check if origin is reached
         for (size_t i = 0; i < nr_dirs; ++i)
         {
             const P& d(dirs[i]);
@@ -85,35 +105,50 @@ void pathfind_with_flood(const P& p0,
                 return;
             }
 
-            if (map_r.is_p_inside(adj_p))
-            {
-                const int adj_val = flood[adj_p.x][adj_p.y];
+            adj_vals[i] =
+                map_r.is_p_inside(adj_p) ?
+                flood.val(adj_p) :
+                0;
 
-                // Mark this as a valid travel direction if it is not blocked,
-                // and is fewer steps from the target than the current cell.
-                valid_offsets[i] =
-                    (adj_val != 0) &&
-                    (adj_val < current_val);
+            if ((adj_vals[i] != 0) && (adj_vals[i] < lowest_adj_val))
+            {
+                lowest_adj_val = adj_vals[i];
             }
         }
 
+        // Mark the cells with the lowest value as valid travel directions, if
+        // they are not blocked, and are closer to the origin than the current
+        // cell. For a normal floodfill, this is every cell one step closer to
+        // the origin - for a weighted floodfill, this follows the cheapest way.
+        for (size_t i = 0; i < nr_dirs; ++i)
+        {
+            valid_offsets[i] =
+                (adj_vals[i] != 0) &&
+                (adj_vals[i] == lowest_adj_val) &&
+                (adj_vals[i] < current_val);
+        }
+
         // Set the next position to one of the valid offsets - either pick one
         // randomly, or iterate over the list and pick the first valid choice.
         if (randomize_steps)
         {
-            std::vector<P> adj_p_bucket;
+            P adj_p_bucket[8];
+
+            int bucket_size = 0;
 
             for (size_t i = 0; i < nr_dirs; ++i)
             {
                 if (valid_offsets[i])
                 {
-                    adj_p_bucket.push_back(p + dirs[i]);
+                    adj_p_bucket[bucket_size] = p + dirs[i];
+
+                    ++bucket_size;
                 }
             }
 
-            ASSERT(!adj_p_bucket.empty());
+            ASSERT(bucket_size > 0);
 
-            adj_p = rnd::element(adj_p_bucket);
+            adj_p = adj_p_bucket[rnd::range(0, bucket_size - 1)];
         }
         else // Do not randomize step choices - iterate over offset list
         {
@@ -133,3 +168,836 @@ void pathfind_with_flood(const P& p0,
 
     } // while
 }
+
+// Flood values from a target, for walking from an origin to the target. The
+// origin itself may be blocked (e.g. by the monster standing there), so it is
+// given a value from its neighbours if it was not reached by the flood.
+class FloodFromTgt
+{
+public:
+    FloodFromTgt(const SearchCtx& ctx,
+                 const P& tgt,
+                 const P& origin,
+                 const std::vector<P>& dirs) :
+        ctx_        (ctx),
+        origin_     (origin),
+        origin_val_ (ctx.val(origin))
+    {
+        if (origin_val_ != 0)
+        {
+            return;
+        }
+
+        for (const P& d : dirs)
+        {
+            const P adj_p(origin + d);
+
+            const int adj_val =
+                (adj_p == tgt) ?
+                0 :
+                ctx.val(adj_p);
+
+            if (((adj_val != 0) || (adj_p == tgt)) &&
+                ((origin_val_ == 0) || ((adj_val + 1) < origin_val_)))
+            {
+                origin_val_ = adj_val + 1;
+            }
+        }
+    }
+
+    int val(const P& p) const
+    {
+        return
+            (p == origin_) ?
+            origin_val_ :
+            ctx_.val(p);
+    }
+
+private:
+    const SearchCtx& ctx_;
+    const P origin_;
+    int origin_val_;
+};
+
+class JpsMap
+{
+public:
+    JpsMap(const bool blocked[map_w][map_h], const P& tgt) :
+        blocked_    (blocked),
+        tgt_        (tgt) {}
+
+    bool is_free(const int x, const int y) const
+    {
+        return
+            flood_bfs::map_flood_bounds.is_p_inside(P(x, y)) &&
+            !blocked_[x][y];
+    }
+
+    bool is_free(const P& p) const
+    {
+        return is_free(p.x, p.y);
+    }
+
+    const P& tgt() const
+    {
+        return tgt_;
+    }
+
+private:
+    const bool (*blocked_)[map_h];
+    const P tgt_;
+};
+
+// Jump from "p" in the direction "d", and find the next jump point - that is,
+// the target, or a cell with forced neighbours.
+bool jump_straight(const JpsMap& map, const P& p, const P& d, P& out)
+{
+    P n(p);
+
+    while (true)
+    {
+        n += d;
+
+        if (!map.is_free(n))
+        {
+            return false;
+        }
+
+        if (n == map.tgt())
+        {
+            out = n;
+            return true;
+        }
+
+        // A cell beside us is free, but could not be reached directly from the
+        // previous cell - this cell is a jump point
+        const bool is_forced =
+            (d.x != 0) ?
+            ((map.is_free(n.x + d.x, n.y + 1) && !map.is_free(n.x, n.y + 1)) ||
+             (map.is_free(n.x + d.x, n.y - 1) && !map.is_free(n.x, n.y - 1))) :
+            ((map.is_free(n.x + 1, n.y + d.y) && !map.is_free(n.x + 1, n.y)) ||
+             (map.is_free(n.x - 1, n.y + d.y) && !map.is_free(n.x - 1, n.y)));
+
+        if (is_forced)
+        {
+            out = n;
+            return true;
+        }
+    }
+}
+
+bool jump_diagonal(const JpsMap& map, const P& p, const P& d, P& out)
+{
+    P n(p);
+
+    P straight_jump_p;
+
+    while (true)
+    {
+        n += d;
+
+        if (!map.is_free(n))
+        {
+            return false;
+        }
+
+        if (n == map.tgt())
+        {
+            out = n;
+            return true;
+        }
+
+        const bool is_forced =
+            (map.is_free(n.x - d.x, n.y + d.y) &&
+             !map.is_free(n.x - d.x, n.y)) ||
+            (map.is_free(n.x + d.x, n.y - d.y) &&
+             !map.is_free(n.x, n.y - d.y));
+
+        if (is_forced ||
+            jump_straight(map, n, P(d.x, 0), straight_jump_p) ||
+            jump_straight(map, n, P(0, d.y), straight_jump_p))
+        {
+            out = n;
+            return true;
+        }
+    }
+}
+
+// Jumping for cardinal movement only - vertical moves are taken before
+// horizontal moves, so a vertical jump stops wherever a horizontal jump from
+// the current cell would find a jump point.
+bool jump_cardinal(const JpsMap& map, const P& p, const P& d, P& out)
+{
+    P n(p);
+
+    P hor_jump_p;
+
+    while (true)
+    {
+        n += d;
+
+        if (!map.is_free(n))
+        {
+            return false;
+        }
+
+        if (n == map.tgt())
+        {
+            out = n;
+            return true;
+        }
+
+        if (d.x != 0)
+        {
+            const bool is_forced =
+                (map.is_free(n.x, n.y + 1) &&
+                 !map.is_free(n.x - d.x, n.y + 1)) ||
+                (map.is_free(n.x, n.y - 1) &&
+                 !map.is_free(n.x - d.x, n.y - 1));
+
+            if (is_forced)
+            {
+                out = n;
+                return true;
+            }
+        }
+        else if (jump_cardinal(map, n, P(1, 0), hor_jump_p) ||
+                 jump_cardinal(map, n, P(-1, 0), hor_jump_p))
+        {
+            out = n;
+            return true;
+        }
+    }
+}
+
+// Returns the number of directions to search from "p", when arriving from the
+// direction "d" (which is zero for the origin)
+int jps_dirs(const JpsMap& map,
+             const P& p,
+             const P& d,
+             const bool allow_diagonal,
+             P dirs_out[8])
+{
+    int nr_dirs = 0;
+
+    if (d == P(0, 0))
+    {
+        const std::vector<P>& all_dirs = allow_diagonal ?
+                                         dir_utils::dir_list :
+                                         dir_utils::cardinal_list;
+
+        for (const P& all_d : all_dirs)
+        {
+            dirs_out[nr_dirs++] = all_d;
+        }
+
+        return nr_dirs;
+    }
+
+    if (!allow_diagonal)
+    {
+        dirs_out[nr_dirs++] = d;
+
+        if (d.x == 0)
+        {
+            dirs_out[nr_dirs++] = P(1, 0);
+            dirs_out[nr_dirs++] = P(-1, 0);
+        }
+        else // Horizontal
+        {
+            if (!map.is_free(p.x - d.x, p.y + 1))
+            {
+                dirs_out[nr_dirs++] = P(0, 1);
+            }
+
+            if (!map.is_free(p.x - d.x, p.y - 1))
+            {
+                dirs_out[nr_dirs++] = P(0, -1);
+            }
+        }
+
+        return nr_dirs;
+    }
+
+    dirs_out[nr_dirs++] = d;
+
+    if ((d.x != 0) && (d.y != 0))
+    {
+        dirs_out[nr_dirs++] = P(d.x, 0);
+        dirs_out[nr_dirs++] = P(0, d.y);
+
+        if (!map.is_free(p.x - d.x, p.y))
+        {
+            dirs_out[nr_dirs++] = P(-d.x, d.y);
+        }
+
+        if (!map.is_free(p.x, p.y - d.y))
+        {
+            dirs_out[nr_dirs++] = P(d.x, -d.y);
+        }
+    }
+    else if (d.x != 0)
+    {
+        if (!map.is_free(p.x, p.y + 1))
+        {
+            dirs_out[nr_dirs++] = P(d.x, 1);
+        }
+
+        if (!map.is_free(p.x, p.y - 1))
+        {
+            dirs_out[nr_dirs++] = P(d.x, -1);
+        }
+    }
+    else // Vertical
+    {
+        if (!map.is_free(p.x + 1, p.y))
+        {
+            dirs_out[nr_dirs++] = P(1, d.y);
+        }
+
+        if (!map.is_free(p.x - 1, p.y))
+        {
+            dirs_out[nr_dirs++] = P(-1, d.y);
+        }
+    }
+
+    return nr_dirs;
+}
+
+} // namespace
+
+void pathfind(const P& p0,
+              const P& p1,
+              const bool blocked[map_w][map_h],
+              std::vector<P>& out,
+              const bool allow_diagonal,
+              const bool randomize_steps)
+{
+    int flood[map_w][map_h];
+
+    floodfill(
+        p0,
+        blocked,
+        flood,
+        -1,
+        p1,
+        allow_diagonal);
+
+    pathfind_with_flood(
+        p0,
+        p1,
+        flood,
+        out,
+        allow_diagonal,
+        randomize_steps);
+}
+
+void pathfind(SearchCtx& ctx,
+              const P& p0,
+              const P& p1,
+              const bool blocked[map_w][map_h],
+              std::vector<P>& out,
+              const bool allow_diagonal,
+              const bool randomize_steps)
+{
+    floodfill(
+        ctx,
+        p0,
+        blocked,
+        -1,
+        p1,
+        allow_diagonal);
+
+    pathfind_with_flood(
+        p0,
+        p1,
+        ctx,
+        out,
+        allow_diagonal,
+        randomize_steps);
+}
+
+void pathfind(const P& p0,
+              const P& p1,
+              const GridView<const bool>& blocked,
+              std::vector<P>& out,
+              const bool allow_diagonal,
+              const bool randomize_steps)
+{
+    const P& dims = blocked.dims();
+
+    std::vector<int> flood_buffer(dims.x * dims.y);
+
+    const GridView<int> flood(flood_buffer.data(), dims, dims.y);
+
+    floodfill(
+        p0,
+        blocked,
+        flood,
+        -1,
+        p1,
+        allow_diagonal);
+
+    pathfind_with_flood(
+        p0,
+        p1,
+        flood,
+        out,
+        allow_diagonal,
+        randomize_steps);
+}
+
+void pathfind_with_flood(const P& p0,
+                         const P& p1,
+                         const int flood[map_w][map_h],
+                         std::vector<P>& out,
+                         const bool allow_diagonal,
+                         const bool randomize_steps)
+{
+    const ConstViewVals vals(flood);
+
+    pathfind_with_flood_impl(
+        p0,
+        p1,
+        vals,
+        out,
+        allow_diagonal,
+        randomize_steps,
+        R(P(0, 0), P(map_w, map_h) - 1));
+}
+
+void pathfind_with_flood(const P& p0,
+                         const P& p1,
+                         const GridView<const int>& flood,
+                         std::vector<P>& out,
+                         const bool allow_diagonal,
+                         const bool randomize_steps)
+{
+    const ConstViewVals vals(flood);
+
+    pathfind_with_flood_impl(
+        p0,
+        p1,
+        vals,
+        out,
+        allow_diagonal,
+        randomize_steps,
+        R(P(0, 0), flood.dims() - 1));
+}
+
+void pathfind_with_flood(const P& p0,
+                         const P& p1,
+                         const SearchCtx& ctx,
+                         std::vector<P>& out,
+                         const bool allow_diagonal,
+                         const bool randomize_steps)
+{
+    pathfind_with_flood_impl(
+        p0,
+        p1,
+        ctx,
+        out,
+        allow_diagonal,
+        randomize_steps,
+        R(P(0, 0), P(map_w, map_h) - 1));
+}
+
+void pathfind_astar(const P& p0,
+                    const P& p1,
+                    const bool blocked[map_w][map_h],
+                    std::vector<P>& out,
+                    const bool allow_diagonal,
+                    const bool randomize_steps)
+{
+    pathfind_astar(
+        thread_search_ctx(),
+        p0,
+        p1,
+        blocked,
+        out,
+        allow_diagonal,
+        randomize_steps);
+}
+
+void pathfind_astar(SearchCtx& ctx,
+                    const P& p0,
+                    const P& p1,
+                    const bool blocked[map_w][map_h],
+                    std::vector<P>& out,
+                    const bool allow_diagonal,
+                    const bool randomize_steps)
+{
+    out.clear();
+
+    const R& bounds = flood_bfs::map_flood_bounds;
+
+    if ((p0 == p1) ||
+        !bounds.is_p_inside(p1) ||
+        blocked[p1.x][p1.y])
+    {
+        return;
+    }
+
+    // Number of steps from the origin to each cell, using the same format as
+    // "floodfill" (zero means not reached), so that "pathfind_with_flood" can
+    // be used for walking back from the target. Only the cells which are
+    // reached are touched.
+    ctx.clear_vals();
+
+    const std::vector<P>& dirs = allow_diagonal ?
+                                 dir_utils::dir_list :
+                                 dir_utils::cardinal_list;
+
+    auto heuristic = [&](const P& p)
+    {
+        return allow_diagonal ?
+            king_dist(p, p1) :
+            taxi_dist(p, p1);
+    };
+
+    const SearchNodeCmp cmp;
+
+    std::vector<SearchNode>& open = ctx.open_nodes();
+
+    open.clear();
+
+    open.push_back(SearchNode(p0, 0, heuristic(p0)));
+
+    bool is_at_tgt = false;
+
+    while (!open.empty())
+    {
+        std::pop_heap(begin(open), end(open), cmp);
+
+        const SearchNode node = open.back();
+
+        open.pop_back();
+
+        const P& p = node.p;
+
+        if (p == p1)
+        {
+            is_at_tgt = true;
+            break;
+        }
+
+        if ((p != p0) && (node.g > ctx.val(p)))
+        {
+            // A shorter way to this cell has been found since it was added
+            continue;
+        }
+
+        const int new_g = node.g + 1;
+
+        for (const P& d : dirs)
+        {
+            const P new_p(p + d);
+
+            if (!bounds.is_p_inside(new_p) ||
+                blocked[new_p.x][new_p.y] ||
+                (new_p == p0))
+            {
+                continue;
+            }
+
+            const int new_p_steps = ctx.val(new_p);
+
+            if ((new_p_steps == 0) || (new_g < new_p_steps))
+            {
+                ctx.set_val(new_p, new_g);
+
+                open.push_back(
+                    SearchNode(new_p, new_g, new_g + heuristic(new_p)));
+
+                std::push_heap(begin(open), end(open), cmp);
+            }
+        }
+    }
+
+    if (!is_at_tgt)
+    {
+        // No path exists
+        return;
+    }
+
+    pathfind_with_flood(
+        p0,
+        p1,
+        ctx,
+        out,
+        allow_diagonal,
+        randomize_steps);
+}
+
+void pathfind_jps(const P& p0,
+                  const P& p1,
+                  const bool blocked[map_w][map_h],
+                  std::vector<P>& out,
+                  const bool allow_diagonal)
+{
+    pathfind_jps(
+        thread_search_ctx(),
+        p0,
+        p1,
+        blocked,
+        out,
+        allow_diagonal);
+}
+
+void pathfind_jps(SearchCtx& ctx,
+                  const P& p0,
+                  const P& p1,
+                  const bool blocked[map_w][map_h],
+                  std::vector<P>& out,
+                  const bool allow_diagonal)
+{
+    out.clear();
+
+    const JpsMap map(blocked, p1);
+
+    if ((p0 == p1) || !map.is_free(p1))
+    {
+        return;
+    }
+
+    // The context values are the steps from the origin to each jump point plus
+    // one (zero means not reached), and the parents are the jump points we
+    // came from. Only the cells which are reached are touched.
+    ctx.clear_vals();
+
+    auto dist = [&](const P& p, const P& other)
+    {
+        return allow_diagonal ?
+            king_dist(p, other) :
+            taxi_dist(p, other);
+    };
+
+    const SearchNodeCmp cmp;
+
+    std::vector<SearchNode>& open = ctx.open_nodes();
+
+    open.clear();
+
+    ctx.set_val(p0, 1);
+
+    open.push_back(SearchNode(p0, 0, dist(p0, p1)));
+
+    bool is_at_tgt = false;
+
+    P dirs[8];
+
+    while (!open.empty())
+    {
+        std::pop_heap(begin(open), end(open), cmp);
+
+        const SearchNode node = open.back();
+
+        open.pop_back();
+
+        const P& p = node.p;
+
+        if (p == p1)
+        {
+            is_at_tgt = true;
+            break;
+        }
+
+        if (node.g > (ctx.val(p) - 1))
+        {
+            // A shorter way to this cell has been found since it was added
+            continue;
+        }
+
+        const P d =
+            (p == p0) ?
+            P(0, 0) :
+            (p - ctx.parent(p)).signs();
+
+        const int nr_dirs = jps_dirs(map, p, d, allow_diagonal, dirs);
+
+        for (int i = 0; i < nr_dirs; ++i)
+        {
+            const P& jump_d = dirs[i];
+
+            P jump_p;
+
+            bool is_found = false;
+
+            if (!allow_diagonal)
+            {
+                is_found = jump_cardinal(map, p, jump_d, jump_p);
+            }
+            else if ((jump_d.x != 0) && (jump_d.y != 0))
+            {
+                is_found = jump_diagonal(map, p, jump_d, jump_p);
+            }
+            else
+            {
+                is_found = jump_straight(map, p, jump_d, jump_p);
+            }
+
+            if (!is_found)
+            {
+                continue;
+            }
+
+            const int new_g = node.g + dist(p, jump_p);
+
+            const int jump_p_val = ctx.val(jump_p);
+
+            if ((jump_p_val == 0) || (new_g < (jump_p_val - 1)))
+            {
+                ctx.set_val(jump_p, new_g + 1);
+
+                ctx.set_parent(jump_p, p);
+
+                open.push_back(
+                    SearchNode(jump_p, new_g, new_g + dist(jump_p, p1)));
+
+                std::push_heap(begin(open), end(open), cmp);
+            }
+        }
+    }
+
+    if (!is_at_tgt)
+    {
+        // No path exists
+        return;
+    }
+
+    out.reserve(ctx.val(p1) - 1);
+
+    // Walk back over the jump points, and add every cell between them
+    P p(p1);
+
+    while (p != p0)
+    {
+        const P& parent = ctx.parent(p);
+
+        const P d((parent - p).signs());
+
+        for (; p != parent; p += d)
+        {
+            out.push_back(p);
+        }
+    }
+}
+
+void pathfind_batch(const std::vector<PathReq>& reqs,
+                    const bool blocked[map_w][map_h],
+                    std::vector< std::vector<P> >& out,
+                    const bool allow_diagonal,
+                    const bool randomize_steps)
+{
+    pathfind_batch(thread_search_ctx(),
+                   reqs,
+                   blocked,
+                   out,
+                   allow_diagonal,
+                   randomize_steps);
+}
+
+void pathfind_batch(SearchCtx& ctx,
+                    const std::vector<PathReq>& reqs,
+                    const bool blocked[map_w][map_h],
+                    std::vector< std::vector<P> >& out,
+                    const bool allow_diagonal,
+                    const bool randomize_steps)
+{
+    out.resize(reqs.size());
+
+    const std::vector<P>& dirs = allow_diagonal ?
+                                 dir_utils::dir_list :
+                                 dir_utils::cardinal_list;
+
+    // Group the requests by target
+    std::vector<size_t> sorted_reqs(reqs.size());
+
+    std::iota(begin(sorted_reqs), end(sorted_reqs), 0);
+
+    std::sort(
+        begin(sorted_reqs),
+        end(sorted_reqs),
+        [&](const size_t i0, const size_t i1)
+        {
+            const P& t0 = reqs[i0].p1;
+            const P& t1 = reqs[i1].p1;
+
+            return (t0.x != t1.x) ? (t0.x < t1.x) : (t0.y < t1.y);
+        });
+
+    std::vector<P> walk;
+
+    size_t group_begin = 0;
+
+    while (group_begin < sorted_reqs.size())
+    {
+        const P& tgt = reqs[sorted_reqs[group_begin]].p1;
+
+        size_t group_end = group_begin + 1;
+
+        while ((group_end < sorted_reqs.size()) &&
+               (reqs[sorted_reqs[group_end]].p1 == tgt))
+        {
+            ++group_end;
+        }
+
+        // A blocked target, or a target on the map edge, is never reached
+        // (same as for "pathfind")
+        const bool is_tgt_free =
+            flood_bfs::map_flood_bounds.is_p_inside(tgt) &&
+            !blocked[tgt.x][tgt.y];
+
+        if (is_tgt_free)
+        {
+            floodfill(ctx,
+                      tgt,
+                      blocked,
+                      -1,
+                      P(-1, -1),
+                      allow_diagonal);
+        }
+
+        for (size_t i = group_begin; i < group_end; ++i)
+        {
+            const size_t req_idx = sorted_reqs[i];
+
+            const P& origin = reqs[req_idx].p0;
+
+            std::vector<P>& path = out[req_idx];
+
+            path.clear();
+
+            if (!is_tgt_free)
+            {
+                continue;
+            }
+
+            const FloodFromTgt flood(ctx, tgt, origin, dirs);
+
+            // Walk from the origin to the target (not including the target),
+            // then reverse this to get the format used by "pathfind"
+            pathfind_with_flood_impl(
+                tgt,
+                origin,
+                flood,
+                walk,
+                allow_diagonal,
+                randomize_steps,
+                R(P(0, 0), P(map_w, map_h) - 1));
+
+            if (walk.empty())
+            {
+                continue;
+            }
+
+            path.reserve(walk.size());
+
+            path.push_back(tgt);
+
+            path.insert(end(path), walk.rbegin(), walk.rend() - 1);
+        }
+
+        group_begin = group_end;
+    }
+}
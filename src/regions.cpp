@@ -0,0 +1,185 @@
+#include "rl_utils.hpp"
+
+#include "flood_bfs.hpp"
+
+namespace
+{
+
+int find_root(std::vector<int>& parents, int idx)
+{
+    int root = idx;
+
+    while (parents[root] != root)
+    {
+        root = parents[root];
+    }
+
+    // Path compression
+    while (parents[idx] != root)
+    {
+        const int next = parents[idx];
+
+        parents[idx] = root;
+
+        idx = next;
+    }
+
+    return root;
+}
+
+void unite(std::vector<int>& parents, const int idx_0, const int idx_1)
+{
+    const int root_0 = find_root(parents, idx_0);
+    const int root_1 = find_root(parents, idx_1);
+
+    if (root_0 != root_1)
+    {
+        parents[std::max(root_0, root_1)] = std::min(root_0, root_1);
+    }
+}
+
+} // namespace
+
+void label_regions(const bool blocked[map_w][map_h],
+                   Array2<int>& ids_out,
+                   std::vector<int>& sizes_out,
+                   const bool allow_diagonal)
+{
+    ids_out.resize(map_w, map_h);
+
+    sizes_out.clear();
+
+    // First pass - give each cell a provisional label from the neighbours
+    // already visited (or a new label), and record which labels are connected
+    std::vector<int> parents;
+
+    // Neighbours visited before the current cell (columns are scanned one at
+    // a time, from the top)
+    const std::vector<P> prev_offsets =
+        allow_diagonal ?
+        std::vector<P> {P(0, -1), P(-1, -1), P(-1, 0), P(-1, 1)} :
+        std::vector<P> {P(0, -1), P(-1, 0)};
+
+    for (int x = 0; x < map_w; ++x)
+    {
+        for (int y = 0; y < map_h; ++y)
+        {
+            const bool is_free =
+                flood_bfs::map_flood_bounds.is_p_inside(P(x, y)) &&
+                !blocked[x][y];
+
+            if (!is_free)
+            {
+                ids_out(x, y) = -1;
+
+                continue;
+            }
+
+            int label = -1;
+
+            for (const P& d : prev_offsets)
+            {
+                const P adj_p(x + d.x, y + d.y);
+
+                // NOTE: Cells outside the map are never checked here, since
+                // the outermost cells are never free
+                const int adj_label = ids_out(adj_p);
+
+                if (adj_label == -1)
+                {
+                    continue;
+                }
+
+                if (label == -1)
+                {
+                    label = adj_label;
+                }
+                else
+                {
+                    unite(parents, label, adj_label);
+                }
+            }
+
+            if (label == -1)
+            {
+                label = parents.size();
+
+                parents.push_back(label);
+            }
+
+            ids_out(x, y) = label;
+        }
+    }
+
+    // Second pass - replace the labels with compact region ids
+    std::vector<int> region_ids(parents.size(), -1);
+
+    for (int x = 0; x < map_w; ++x)
+    {
+        for (int y = 0; y < map_h; ++y)
+        {
+            int& id = ids_out(x, y);
+
+            if (id == -1)
+            {
+                continue;
+            }
+
+            const int root = find_root(parents, id);
+
+            if (region_ids[root] == -1)
+            {
+                region_ids[root] = sizes_out.size();
+
+                sizes_out.push_back(0);
+            }
+
+            id = region_ids[root];
+
+            ++sizes_out[id];
+        }
+    }
+}
+
+bool is_reachable(const Array2<int>& ids,
+                  const P& p0,
+                  const P& p1,
+                  const bool allow_diagonal)
+{
+    if (p0 == p1)
+    {
+        return true;
+    }
+
+    const int tgt_id = ids(p1);
+
+    if (tgt_id == -1)
+    {
+        return false;
+    }
+
+    const int origin_id = ids(p0);
+
+    if (origin_id != -1)
+    {
+        return origin_id == tgt_id;
+    }
+
+    const std::vector<P>& dirs = allow_diagonal ?
+                                 dir_utils::dir_list :
+                                 dir_utils::cardinal_list;
+
+    const R map_r(P(0, 0), ids.dims() - 1);
+
+    for (const P& d : dirs)
+    {
+        const P adj_p(p0 + d);
+
+        if (map_r.is_p_inside(adj_p) && (ids(adj_p) == tgt_id))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,37 @@
+#include "rl_utils.hpp"
+
+#include <memory>
+
+SearchCtx::SearchCtx() :
+    gen_        (1),
+    positions_  (),
+    open_nodes_ ()
+{
+    std::fill_n(*gen_stamps_, nr_map_cells, 0);
+
+    // In the worst case a search visits every position, reserve elements
+    positions_.reserve(nr_map_cells);
+}
+
+void SearchCtx::clear_vals()
+{
+    ++gen_;
+
+    if (gen_ == 0)
+    {
+        // The generation counter wrapped around, so old stamps could now match
+        // new generations - reset all stamps
+        std::fill_n(*gen_stamps_, nr_map_cells, 0);
+
+        gen_ = 1;
+    }
+}
+
+SearchCtx& thread_search_ctx()
+{
+    // NOTE: Allocated on the heap, since the context is too big for the
+    // thread local storage of some platforms
+    thread_local std::unique_ptr<SearchCtx> ctx(new SearchCtx);
+
+    return *ctx;
+}
@@ -0,0 +1,97 @@
+#include "rl_utils.hpp"
+
+#include "flood_bfs.hpp"
+
+SlicedSearch::SlicedSearch() :
+    ctx_                (),
+    blocked_            (nullptr),
+    p0_                 (),
+    p1_                 (),
+    allow_diagonal_     (true),
+    randomize_steps_    (false),
+    state_              (SearchState::no_path),
+    next_p_idx_         (0),
+    nr_nodes_expanded_  (0),
+    path_               () {}
+
+void SlicedSearch::start(const P& p0,
+                         const P& p1,
+                         const bool blocked[map_w][map_h],
+                         const bool allow_diagonal,
+                         const bool randomize_steps)
+{
+    blocked_ = blocked;
+    p0_ = p0;
+    p1_ = p1;
+    allow_diagonal_ = allow_diagonal;
+    randomize_steps_ = randomize_steps;
+    next_p_idx_ = 0;
+    nr_nodes_expanded_ = 0;
+
+    path_.clear();
+
+    ctx_.clear_vals();
+
+    std::vector<P>& positions = ctx_.positions();
+
+    positions.clear();
+
+    positions.push_back(p0);
+
+    state_ =
+        (p0 == p1) ?
+        SearchState::found :
+        SearchState::in_progress;
+}
+
+SearchState SlicedSearch::step(const int node_budget)
+{
+    if (state_ != SearchState::in_progress)
+    {
+        return state_;
+    }
+
+    const GridView<const bool> blocked(blocked_);
+
+    // The breadth first search of floodfill, continuing from where the
+    // previous call stopped (the positions to evaluate are kept in the context)
+    for (int i = 0; i < node_budget; ++i)
+    {
+        const flood_bfs::StepResult result =
+            flood_bfs::expand_next(p0_,
+                                   blocked,
+                                   ctx_,
+                                   -1,
+                                   p1_,
+                                   allow_diagonal_,
+                                   ctx_.positions(),
+                                   next_p_idx_,
+                                   flood_bfs::map_flood_bounds);
+
+        if (result == flood_bfs::StepResult::done)
+        {
+            state_ = SearchState::no_path;
+
+            return state_;
+        }
+
+        ++nr_nodes_expanded_;
+
+        if (result == flood_bfs::StepResult::tgt_reached)
+        {
+            pathfind_with_flood(
+                p0_,
+                p1_,
+                ctx_,
+                path_,
+                allow_diagonal_,
+                randomize_steps_);
+
+            state_ = SearchState::found;
+
+            return state_;
+        }
+    }
+
+    return state_;
+}